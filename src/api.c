@@ -1,270 +1,397 @@
 ﻿#include "api.h"
-#include "cJSON.h"
+#include "lesson_parser.h"
 #include <curl/curl.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
+#include <strings.h>
 
-// Callback for libcurl
+// Number of transfers the fetch engine runs in parallel
+#define MAX_PARALLEL_FETCHES 6
+// Seconds a resolved host name stays in the shared DNS cache
+#define DNS_CACHE_TIMEOUT_S 600
+// Idle time before TCP keep-alive probes are sent on a pooled connection
+#define TCP_KEEPIDLE_S 60
+#define TCP_KEEPINTVL_S 30
+
+// A reusable transfer slot of the fetch engine
+typedef struct {
+    CURL* curl;
+    lesson_parser_t* parser; /* Parses the response body while it is downloaded */
+    size_t response_size;   /* Decoded body bytes received */
+    char* etag;             /* Validators received with the response */
+    char* last_modified;
+    struct curl_slist* headers; /* Conditional request headers */
+    void* user_data;
+    bool busy;
+} fetch_transfer_t;
+
+// Persistent fetch context: the multi handle drives all transfers and keeps the connection pool,
+// the share lets every handle reuse DNS entries, TLS sessions and connections
+static struct {
+    CURLSH* share;
+    CURLM* multi;
+    fetch_transfer_t transfers[MAX_PARALLEL_FETCHES];
+    pthread_mutex_t locks[CURL_LOCK_DATA_LAST];
+    pthread_mutex_t stats_mutex;
+    api_transfer_stats_t stats;
+} fetch_context = { .stats_mutex = PTHREAD_MUTEX_INITIALIZER };
+
+static void share_lock_callback(CURL* handle, curl_lock_data data, curl_lock_access access, void* userp)
+{
+    (void)handle;
+    (void)access;
+    (void)userp;
+    pthread_mutex_lock(&fetch_context.locks[data]);
+}
+
+static void share_unlock_callback(CURL* handle, curl_lock_data data, void* userp)
+{
+    (void)handle;
+    (void)userp;
+    pthread_mutex_unlock(&fetch_context.locks[data]);
+}
+
+// Callback for libcurl, feeds each decoded chunk of the body to the parser
 static size_t write_callback(void* contents, size_t size, size_t nmemb, void* userp)
 {
     size_t realsize = size * nmemb;
-    char** response = (char**)userp;
-    size_t oldsize = *response ? strlen(*response) : 0;
-    char* new_response = realloc(*response, oldsize + realsize + 1);
-    if (!new_response)
+    fetch_transfer_t* transfer = (fetch_transfer_t*)userp;
+    transfer->response_size += realsize;
+
+    // Error responses are not schedules, their status is checked once the transfer ends
+    long http_code = 0;
+    curl_easy_getinfo(transfer->curl, CURLINFO_RESPONSE_CODE, &http_code);
+    if (http_code == 200 && lesson_parser_feed(transfer->parser, (const char*)contents, realsize) != 0)
     {
-        fprintf(stderr, "Failed to realloc response buffer\n");
+        // Abort the transfer, the rest of a malformed response is not worth downloading
         return 0;
     }
-    *response = new_response;
-    memcpy(*response + oldsize, contents, realsize);
-    (*response)[oldsize + realsize] = '\0';
     return realsize;
 }
 
-// Dictionary of lesson types and their background colors
-static const struct {
-    const char* api_type;
-    const char* display_type;
-    uint32_t color;
-} type_colors[] = {
-    {"лек.", "Лекции", 0x276093},
-    {"экз.", "Экзамен", 0xe91e63},
-    {"курс.р.", "Курсовая работа", 0x407ab2},
-    {"лаб.", "Лабораторные занятия", 0x3e8470},
-    {"курс.пр.", "Курсовой проект", 0x276093},
-    {"Сам.", "Самостоятельная работа студента", 0x276093},
-    {"кн.р.", "Контрольная работа", 0x276093},
-    {"дип.", "Дипломный проект", 0x276093},
-    {"Пересдача", "Пересдача", 0x276093},
-    {"конс.д.", "Консультация по дисциплине", 0x3e8470},
-    {"инд.", "Консультация индивидуальная", 0x276093},
-    {"практ.зан.  и семин.", "Практические занятия и семинары", 0xff8f00},
-    {"НИР", "НИР", 0x276093},
-    {"диф.зач.", "Дифференцированный зачет", 0xe91e63},
-    {"Рук.", "ГЭК, Консультации к диплому, руководство", 0x276093},
-    {"гос.", "Госэкзамен", 0x276093},
-    {"Доп.", "Дополнительная нагрузка", 0x276093},
-    {"конс.эк.", "Консультация к промежуточной аттестации", 0x9e5fa1},
-    {"К.сам.", "Контроль самостоятельной работы", 0x276093},
-    {"прак.", "Практика", 0xe91e63},
-    {"зач.", "Зачет", 0xe91e63},
-    {"-", "-", 0x407ab2},
-    {NULL, NULL, 0xCCCCCC}
-};
-
-int fetch_schedule_data(const char* room_id, const struct tm* date, lesson_t** lessons, int* lesson_count)
+// Copies the value of a response header line if it has the given name
+static void capture_header(const char* line, size_t length, const char* name, char** value)
 {
-    CURL* curl = curl_easy_init();
-    if (!curl)
-    {
-        fprintf(stderr, "Failed to initialize curl\n");
-        return -1;
-    }
+    size_t name_length = strlen(name);
+    if (length <= name_length || line[name_length] != ':' || strncasecmp(line, name, name_length) != 0) return;
 
-    char url[256];
-    snprintf(url, sizeof(url), "https://mapapi.susu.ru/integration/map/Schedule/roomId/%s/date/%02d.%02d.%04d",
-        room_id, date->tm_mday, date->tm_mon + 1, date->tm_year + 1900);
+    const char* start = line + name_length + 1;
+    const char* end = line + length;
+    while (start < end && (*start == ' ' || *start == '\t')) start++;
+    while (end > start && (end[-1] == '\r' || end[-1] == '\n' || end[-1] == ' ')) end--;
 
-    //printf("Fetching URL: %s\n", url);
+    free(*value);
+    *value = strndup(start, (size_t)(end - start));
+}
 
-    char* response = malloc(1);
-    if (!response)
-    {
-        fprintf(stderr, "Failed to allocate response buffer\n");
-        curl_easy_cleanup(curl);
-        return -1;
-    }
-    response[0] = '\0';
+// Callback for libcurl, called for every response header line
+static size_t header_callback(char* buffer, size_t size, size_t nitems, void* userp)
+{
+    size_t length = size * nitems;
+    fetch_transfer_t* transfer = (fetch_transfer_t*)userp;
+    capture_header(buffer, length, "ETag", &transfer->etag);
+    capture_header(buffer, length, "Last-Modified", &transfer->last_modified);
+    return length;
+}
 
-    curl_easy_setopt(curl, CURLOPT_URL, url);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+// Forgets the validators and request headers of the previous transfer of a slot
+static void reset_transfer_headers(fetch_transfer_t* transfer)
+{
+    free(transfer->etag);
+    free(transfer->last_modified);
+    curl_slist_free_all(transfer->headers);
+    transfer->etag = NULL;
+    transfer->last_modified = NULL;
+    transfer->headers = NULL;
+}
 
-    CURLcode result = curl_easy_perform(curl);
+int api_init(void)
+{
+    CURLcode result = curl_global_init(CURL_GLOBAL_DEFAULT);
     if (result != CURLE_OK)
     {
-        fprintf(stderr, "curl_easy_perform() failed: %s\n", curl_easy_strerror(result));
-        free(response);
-        curl_easy_cleanup(curl);
+        fprintf(stderr, "curl_global_init() failed: %s\n", curl_easy_strerror(result));
         return -1;
     }
 
-    curl_easy_cleanup(curl);
+    for (int i = 0; i < CURL_LOCK_DATA_LAST; i++)
+    {
+        pthread_mutex_init(&fetch_context.locks[i], NULL);
+    }
 
-    // Parsing JSON
-    cJSON* json = cJSON_Parse(response);
-    if (!json)
+    fetch_context.share = curl_share_init();
+    if (!fetch_context.share)
     {
-        fprintf(stderr, "Failed to parse JSON: %s\n", cJSON_GetErrorPtr());
-        free(response);
+        fprintf(stderr, "Failed to initialize curl share\n");
+        api_cleanup();
         return -1;
     }
+    curl_share_setopt(fetch_context.share, CURLSHOPT_LOCKFUNC, share_lock_callback);
+    curl_share_setopt(fetch_context.share, CURLSHOPT_UNLOCKFUNC, share_unlock_callback);
+    curl_share_setopt(fetch_context.share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(fetch_context.share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    curl_share_setopt(fetch_context.share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
 
-    // Check that this is an array
-    if (!cJSON_IsArray(json))
+    fetch_context.multi = curl_multi_init();
+    if (!fetch_context.multi)
     {
-        fprintf(stderr, "JSON response is not an array\n");
-        cJSON_Delete(json);
-        free(response);
+        fprintf(stderr, "Failed to initialize curl multi\n");
+        api_cleanup();
         return -1;
     }
+    // Multiplex parallel requests over one HTTP/2 connection when the server allows it
+    curl_multi_setopt(fetch_context.multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    curl_multi_setopt(fetch_context.multi, CURLMOPT_MAX_HOST_CONNECTIONS, (long)MAX_PARALLEL_FETCHES);
 
-    // Initialize lessons and lesson_count
-    *lessons = NULL;
-    *lesson_count = 0;
-
-    // Parse JSON array
-    int array_size = cJSON_GetArraySize(json);
-    for (int i = 0; i < array_size; i++)
+    for (int i = 0; i < MAX_PARALLEL_FETCHES; i++)
     {
-        cJSON* item = cJSON_GetArrayItem(json, i);
-        cJSON* type = cJSON_GetObjectItem(item, "Type");
-        cJSON* groups = cJSON_GetObjectItem(item, "Groups");
-        cJSON* teacher = cJSON_GetObjectItem(item, "Teacher");
-
-        // Check if Groups and Teacher are empty
-        bool groups_empty = !groups || cJSON_IsNull(groups) || (cJSON_IsString(groups) && strlen(groups->valuestring) == 0);
-        bool teacher_empty = !teacher || cJSON_IsNull(teacher) || (cJSON_IsString(teacher) && strlen(teacher->valuestring) == 0);
-
-        // Skip if Type is null AND at least one of Groups or Teacher is empty
-        // OR if both Groups and Teacher are empty
-        if ((type && cJSON_IsNull(type) && (groups_empty || teacher_empty)) || (groups_empty && teacher_empty))
+        fetch_transfer_t* transfer = &fetch_context.transfers[i];
+        transfer->curl = curl_easy_init();
+        transfer->parser = lesson_parser_create();
+        if (!transfer->curl || !transfer->parser)
         {
-            continue;
-        }
-
-        // Allocate memory for one more lesson
-        lesson_t* tmp_lessons = realloc(*lessons, (*lesson_count + 1) * sizeof(lesson_t));
-        if (!tmp_lessons)
-        {
-            fprintf(stderr, "Failed to allocate memory for lesson %d\n", i);
-            free(*lessons);
-            cJSON_Delete(json);
-            free(response);
+            fprintf(stderr, "Failed to initialize curl\n");
+            api_cleanup();
             return -1;
         }
-        *lessons = tmp_lessons;
-        lesson_t* lesson = &(*lessons)[*lesson_count];
-
-        // Initialize default values
-        lesson->subject = NULL;
-        lesson->teacher = NULL;
-        lesson->type = NULL;
-        lesson->groups = NULL;
-        lesson->color = 0xCCCCCC;
-        lesson->start_hour = 0;
-        lesson->start_minute = 0;
-        lesson->end_hour = 0;
-        lesson->end_minute = 0;
-
-        cJSON* period = cJSON_GetObjectItem(item, "Period");
-        cJSON* subject = cJSON_GetObjectItem(item, "Subject");
-
-        // Validate JSON fields
-        if (!period || !cJSON_IsString(period) ||
-            !subject || !cJSON_IsString(subject) ||
-            !groups || !cJSON_IsString(groups) ||
-            !teacher || !cJSON_IsString(teacher))
+
+        // Options that stay the same for every request
+        curl_easy_setopt(transfer->curl, CURLOPT_SHARE, fetch_context.share);
+        curl_easy_setopt(transfer->curl, CURLOPT_PRIVATE, transfer);
+        curl_easy_setopt(transfer->curl, CURLOPT_WRITEFUNCTION, write_callback);
+        curl_easy_setopt(transfer->curl, CURLOPT_WRITEDATA, transfer);
+        curl_easy_setopt(transfer->curl, CURLOPT_HEADERFUNCTION, header_callback);
+        curl_easy_setopt(transfer->curl, CURLOPT_HEADERDATA, transfer);
+        curl_easy_setopt(transfer->curl, CURLOPT_PIPEWAIT, 1L);
+        // Offer every encoding libcurl was built with (gzip, deflate, brotli...), bodies are
+        // decompressed on the fly before reaching write_callback()
+        curl_easy_setopt(transfer->curl, CURLOPT_ACCEPT_ENCODING, "");
+        curl_easy_setopt(transfer->curl, CURLOPT_DNS_CACHE_TIMEOUT, (long)DNS_CACHE_TIMEOUT_S);
+        curl_easy_setopt(transfer->curl, CURLOPT_TCP_KEEPALIVE, 1L);
+        curl_easy_setopt(transfer->curl, CURLOPT_TCP_KEEPIDLE, (long)TCP_KEEPIDLE_S);
+        curl_easy_setopt(transfer->curl, CURLOPT_TCP_KEEPINTVL, (long)TCP_KEEPINTVL_S);
+    }
+
+    return 0;
+}
+
+void api_cleanup(void)
+{
+    for (int i = 0; i < MAX_PARALLEL_FETCHES; i++)
+    {
+        fetch_transfer_t* transfer = &fetch_context.transfers[i];
+        if (transfer->curl)
         {
-            fprintf(stderr, "Invalid JSON structure for lesson %d\n", i);
-            lesson->subject = strdup("");
-            lesson->teacher = strdup("");
-            lesson->type = strdup("");
-            lesson->groups = strdup("");
-            (*lesson_count)++;
-            continue;
+            if (transfer->busy && fetch_context.multi)
+            {
+                curl_multi_remove_handle(fetch_context.multi, transfer->curl);
+            }
+            curl_easy_cleanup(transfer->curl);
         }
+        lesson_parser_destroy(transfer->parser);
+        reset_transfer_headers(transfer);
+        memset(transfer, 0, sizeof(*transfer));
+    }
+
+    if (fetch_context.multi)
+    {
+        curl_multi_cleanup(fetch_context.multi);
+        fetch_context.multi = NULL;
+    }
 
-        // Time parsing ("HH:MM:SS-HH:MM:SS")
-        int start_hour, start_minute, end_hour, end_minute;
-        int parsed = sscanf(period->valuestring, "%02d:%02d:%*d-%02d:%02d:%*d",
-            &start_hour, &start_minute, &end_hour, &end_minute);
-        if (parsed != 4)
+    if (fetch_context.share)
+    {
+        curl_share_cleanup(fetch_context.share);
+        fetch_context.share = NULL;
+    }
+
+    for (int i = 0; i < CURL_LOCK_DATA_LAST; i++)
+    {
+        pthread_mutex_destroy(&fetch_context.locks[i]);
+    }
+
+    curl_global_cleanup();
+}
+
+int api_start_fetch(const char* room_id, const struct tm* date, const char* etag, const char* last_modified,
+    void* user_data)
+{
+    if (!fetch_context.multi) return -1;
+
+    fetch_transfer_t* transfer = NULL;
+    for (int i = 0; i < MAX_PARALLEL_FETCHES; i++)
+    {
+        if (!fetch_context.transfers[i].busy)
         {
-            fprintf(stderr, "Failed to parse period string for lesson %d: '%s'\n", i, period->valuestring);
-            lesson->subject = strdup("");
-            lesson->teacher = strdup("");
-            lesson->type = strdup("");
-            lesson->groups = strdup("");
-            (*lesson_count)++;
-            continue;
+            transfer = &fetch_context.transfers[i];
+            break;
         }
+    }
+    if (!transfer) return -1;
 
-        lesson->start_hour = start_hour;
-        lesson->start_minute = start_minute;
-        lesson->end_hour = end_hour;
-        lesson->end_minute = end_minute;
+    char url[256];
+    snprintf(url, sizeof(url), "https://mapapi.susu.ru/integration/map/Schedule/roomId/%s/date/%02d.%02d.%04d",
+        room_id, date->tm_mday, date->tm_mon + 1, date->tm_year + 1900);
 
-        lesson->subject = strdup(subject->valuestring);
-        lesson->teacher = strdup(teacher_empty ? "-" : teacher->valuestring);
-        lesson->groups = strdup(groups_empty ? "-" : groups->valuestring);
+    //printf("Fetching URL: %s\n", url);
+
+    // Ask the server to answer 304 if the cached schedule is still current
+    reset_transfer_headers(transfer);
+    char header[256];
+    if (etag)
+    {
+        snprintf(header, sizeof(header), "If-None-Match: %s", etag);
+        transfer->headers = curl_slist_append(transfer->headers, header);
+    }
+    if (last_modified)
+    {
+        snprintf(header, sizeof(header), "If-Modified-Since: %s", last_modified);
+        transfer->headers = curl_slist_append(transfer->headers, header);
+    }
+
+    curl_easy_setopt(transfer->curl, CURLOPT_URL, url);
+    curl_easy_setopt(transfer->curl, CURLOPT_HTTPHEADER, transfer->headers);
+    transfer->response_size = 0;
+    lesson_parser_reset(transfer->parser);
+    transfer->user_data = user_data;
+
+    CURLMcode result = curl_multi_add_handle(fetch_context.multi, transfer->curl);
+    if (result != CURLM_OK)
+    {
+        fprintf(stderr, "curl_multi_add_handle() failed: %s\n", curl_multi_strerror(result));
+        return -1;
+    }
+    transfer->busy = true;
+
+    return 0;
+}
+
+// Adds a finished transfer to the counters
+static void count_transfer(fetch_transfer_t* transfer, int status)
+{
+    curl_off_t wire_bytes = 0;
+    curl_easy_getinfo(transfer->curl, CURLINFO_SIZE_DOWNLOAD_T, &wire_bytes);
+
+    pthread_mutex_lock(&fetch_context.stats_mutex);
+    fetch_context.stats.fetches++;
+    fetch_context.stats.not_modified += status == API_FETCH_NOT_MODIFIED;
+    fetch_context.stats.wire_bytes += (uint64_t)wire_bytes;
+    fetch_context.stats.decoded_bytes += transfer->response_size;
+    pthread_mutex_unlock(&fetch_context.stats_mutex);
+}
+
+int api_perform_fetches(int timeout_ms, api_fetch_done_cb_t done_cb)
+{
+    if (!fetch_context.multi) return 0;
+
+    int running = 0;
+    CURLMcode mresult = curl_multi_perform(fetch_context.multi, &running);
+    if (mresult != CURLM_OK)
+    {
+        fprintf(stderr, "curl_multi_perform() failed: %s\n", curl_multi_strerror(mresult));
+    }
 
-        // Check for memory allocation failure
-        if (!lesson->subject || !lesson->teacher || !lesson->groups)
+    // Dispatch finished transfers
+    CURLMsg* message;
+    int messages_left;
+    while ((message = curl_multi_info_read(fetch_context.multi, &messages_left)))
+    {
+        if (message->msg != CURLMSG_DONE) continue;
+
+        fetch_transfer_t* transfer = NULL;
+        curl_easy_getinfo(message->easy_handle, CURLINFO_PRIVATE, (char**)&transfer);
+        CURLcode result = message->data.result;
+        curl_multi_remove_handle(fetch_context.multi, transfer->curl);
+
+        api_fetch_response_t response = { .status = -1 };
+
+        long http_code = 0;
+        curl_easy_getinfo(transfer->curl, CURLINFO_RESPONSE_CODE, &http_code);
+        if (result == CURLE_WRITE_ERROR)
         {
-            fprintf(stderr, "Memory allocation failed for lesson %d strings\n", i);
-            free(lesson->subject);
-            free(lesson->teacher);
-            free(lesson->groups);
-            free(lesson->type);
-            free(*lessons);
-            cJSON_Delete(json);
-            free(response);
-            return -1;
+            // Aborted by write_callback(), the parser has reported why
+            fprintf(stderr, "Schedule fetch failed: the response is malformed\n");
         }
-
-        if (!type || cJSON_IsNull(type))
+        else if (result != CURLE_OK)
         {
-            for (size_t j = 0; type_colors[j].api_type != NULL; j++)
-            {
-                if (strcmp(type_colors[j].api_type, "-") == 0)
-                {
-                    lesson->type = strdup(type_colors[j].display_type);
-                    lesson->color = type_colors[j].color;
-                    break;
-                }
-            }
+            fprintf(stderr, "Schedule fetch failed: %s\n", curl_easy_strerror(result));
         }
-        else if (cJSON_IsString(type))
+        else if (http_code == 304)
         {
-            lesson->type = strdup(type->valuestring);
-            for (size_t j = 0; type_colors[j].api_type != NULL; j++)
-            {
-                if (strcmp(type->valuestring, type_colors[j].api_type) == 0)
-                {
-                    free(lesson->type);
-                    lesson->type = strdup(type_colors[j].display_type);
-                    lesson->color = type_colors[j].color;
-                    break;
-                }
-            }
+            // The cached schedule is current, there is no body to parse
+            response.status = API_FETCH_NOT_MODIFIED;
+        }
+        else if (http_code != 200)
+        {
+            fprintf(stderr, "Schedule fetch failed: HTTP %ld\n", http_code);
         }
         else
         {
-            lesson->type = strdup("");
+            // The body has been parsed while it was downloaded
+            response.status = lesson_parser_finish(transfer->parser, &response.lessons);
         }
-
-        // Check for type memory allocation failure
-        if (!lesson->type)
+        if (response.status != 0)
         {
-            fprintf(stderr, "Memory allocation failed for lesson %d type\n", i);
-            free(lesson->subject);
-            free(lesson->teacher);
-            free(lesson->groups);
-            free(lesson->type);
-            free(*lessons);
-            cJSON_Delete(json);
-            free(response);
-            return -1;
+            response.lessons = NULL;
         }
+        if (response.status != -1)
+        {
+            // Hand the validators over to be sent with the next request for the day
+            response.etag = transfer->etag;
+            response.last_modified = transfer->last_modified;
+            transfer->etag = NULL;
+            transfer->last_modified = NULL;
+        }
+        reset_transfer_headers(transfer);
+        count_transfer(transfer, response.status);
 
-        (*lesson_count)++;
+        transfer->busy = false;
+        done_cb(transfer->user_data, &response);
     }
 
-    cJSON_Delete(json);
-    free(response);
-    return 0;
+    if (running > 0)
+    {
+        // Sleep until there is network activity, the timeout expires or api_wakeup() is called
+        curl_multi_poll(fetch_context.multi, NULL, 0, timeout_ms, NULL);
+    }
+
+    return running;
+}
+
+void api_cancel_fetches(void (*cancel_cb)(void* user_data))
+{
+    for (int i = 0; i < MAX_PARALLEL_FETCHES; i++)
+    {
+        fetch_transfer_t* transfer = &fetch_context.transfers[i];
+        if (!transfer->busy) continue;
+
+        curl_multi_remove_handle(fetch_context.multi, transfer->curl);
+        reset_transfer_headers(transfer);
+        transfer->busy = false;
+        if (cancel_cb)
+        {
+            cancel_cb(transfer->user_data);
+        }
+        transfer->user_data = NULL;
+    }
+}
+
+void api_get_transfer_stats(api_transfer_stats_t* stats)
+{
+    if (!stats) return;
+
+    pthread_mutex_lock(&fetch_context.stats_mutex);
+    *stats = fetch_context.stats;
+    pthread_mutex_unlock(&fetch_context.stats_mutex);
+}
+
+void api_wakeup(void)
+{
+    if (fetch_context.multi)
+    {
+        curl_multi_wakeup(fetch_context.multi);
+    }
 }
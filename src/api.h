@@ -1,10 +1,96 @@
 ﻿#ifndef API_H
 #define API_H
 
-#include "schedule_data.h"
+#include "lesson_day.h"
 
 struct tm;
 
-int fetch_schedule_data(const char* room_id, const struct tm* date, lesson_t** lessons, int* lesson_count);
+/**
+ * Initializes the network layer.
+ * @return 0 on success, -1 on error.
+ * @note Must be called once before any fetch, while the program is still single-threaded.
+ */
+int api_init(void);
+
+/**
+ * Releases resources held by the network layer.
+ */
+void api_cleanup(void);
+
+// Status of a conditional fetch whose schedule has not changed on the server
+#define API_FETCH_NOT_MODIFIED 1
+
+/**
+ * Outcome of a finished fetch. Ownership of the lessons and validators passes to the callback.
+ */
+typedef struct {
+    int status;             /* 0 on success, API_FETCH_NOT_MODIFIED on a 304 response, -1 on error */
+    lesson_day_t* lessons;  /* Newly allocated lessons (NULL unless status is 0), release them with lesson_day_release() */
+    char* etag;             /* ETag header of the response, NULL if absent */
+    char* last_modified;    /* Last-Modified header of the response, NULL if absent */
+} api_fetch_response_t;
+
+/**
+ * Called by api_perform_fetches() for every finished fetch.
+ * @param user_data The pointer given to api_start_fetch().
+ * @param response  Pointer to the outcome of the fetch.
+ */
+typedef void (*api_fetch_done_cb_t)(void* user_data, api_fetch_response_t* response);
+
+/**
+ * Starts fetching the schedule of a room for a given date.
+ * The transfer runs on the persistent fetch context, reusing its pooled connections,
+ * cached DNS entries and TLS sessions, and progresses in api_perform_fetches().
+ * When validators of a previous response are given, the request is conditional and an
+ * unchanged schedule is reported as API_FETCH_NOT_MODIFIED without a body to parse.
+ * @param room_id       Pointer to a string containing the room ID.
+ * @param date          Pointer to a struct tm containing the date to fetch (year, month, day).
+ * @param etag          ETag of the cached schedule, NULL if unknown.
+ * @param last_modified Last-Modified date of the cached schedule, NULL if unknown.
+ * @param user_data     Pointer passed back to the completion callback.
+ * @return 0 if the transfer was started, -1 if all transfer slots are busy or on error.
+ */
+int api_start_fetch(const char* room_id, const struct tm* date, const char* etag, const char* last_modified,
+    void* user_data);
+
+/**
+ * Drives the running transfers in parallel and reports finished ones.
+ * Waits up to timeout_ms for network activity while transfers are running.
+ * @param timeout_ms  Maximum time to wait for network activity in milliseconds.
+ * @param done_cb     Callback invoked for every finished fetch.
+ * @return The number of transfers still running.
+ * @note api_start_fetch() and api_perform_fetches() must be called from the same thread,
+ *       which must not be the LVGL thread.
+ */
+int api_perform_fetches(int timeout_ms, api_fetch_done_cb_t done_cb);
+
+/**
+ * Aborts every running transfer without reporting it to a completion callback.
+ * @param cancel_cb Function called with the user_data of each aborted transfer, e.g. to free it.
+ * @note Must be called from the thread that drives the transfers.
+ */
+void api_cancel_fetches(void (*cancel_cb)(void* user_data));
+
+/**
+ * Interrupts a wait in api_perform_fetches(). Safe to call from any thread.
+ */
+void api_wakeup(void);
+
+/**
+ * Transfer counters of the fetch engine.
+ */
+typedef struct {
+    uint32_t fetches;           /* Finished transfers, successful or not */
+    uint32_t not_modified;      /* Transfers answered with 304 */
+    uint64_t wire_bytes;        /* Response body bytes received, before decompression */
+    uint64_t decoded_bytes;     /* Response body bytes after decompression */
+} api_transfer_stats_t;
+
+/**
+ * Reads the transfer counters. The compression ratio achieved is decoded_bytes / wire_bytes.
+ * @param stats Pointer to an api_transfer_stats_t that receives the counters.
+ * @note Safe to call from any thread.
+ */
+void api_get_transfer_stats(api_transfer_stats_t* stats);
 
 #endif
@@ -6,7 +6,9 @@
 
 Config read_config(const char* filename)
 {
-    Config config = { .roomId = NULL, .isDarkTheme = false, .inactiveDurationMs = 60000 }; // Default values
+    Config config = { .roomId = NULL, .isDarkTheme = false, .inactiveDurationMs = 60000, .prefetchDays = 7,
+        .cacheMaxAgeMinutes = 10, .cacheTtlMinutes = 360, .cacheMemoryLimitKb = 512, .cacheFile = NULL,
+        .daySwitchFadeMs = 0 }; // Default values
 
     // Read the file
     FILE* file = fopen(filename, "r");
@@ -85,6 +87,96 @@ Config read_config(const char* filename)
         fprintf(stderr, "inactiveDurationMs not found or not a number in config\n");
     }
 
+    // Read prefetchDays
+    cJSON* prefetch_days_item = cJSON_GetObjectItem(json, "prefetchDays");
+    if (cJSON_IsNumber(prefetch_days_item))
+    {
+        config.prefetchDays = prefetch_days_item->valueint;
+        if (config.prefetchDays < 0)
+        {
+            fprintf(stderr, "prefetchDays is invalid, using default: 7\n");
+            config.prefetchDays = 7;
+        }
+    }
+    else
+    {
+        fprintf(stderr, "prefetchDays not found or not a number in config\n");
+    }
+
+    // Read cacheMaxAgeMinutes
+    cJSON* cache_max_age_item = cJSON_GetObjectItem(json, "cacheMaxAgeMinutes");
+    if (cJSON_IsNumber(cache_max_age_item))
+    {
+        config.cacheMaxAgeMinutes = (uint32_t)cache_max_age_item->valuedouble;
+        if (config.cacheMaxAgeMinutes == 0)
+        {
+            fprintf(stderr, "cacheMaxAgeMinutes is invalid, using default: 10\n");
+            config.cacheMaxAgeMinutes = 10;
+        }
+    }
+    else
+    {
+        fprintf(stderr, "cacheMaxAgeMinutes not found or not a number in config\n");
+    }
+
+    // Read cacheTtlMinutes
+    cJSON* cache_ttl_item = cJSON_GetObjectItem(json, "cacheTtlMinutes");
+    if (cJSON_IsNumber(cache_ttl_item))
+    {
+        config.cacheTtlMinutes = (uint32_t)cache_ttl_item->valuedouble;
+        if (config.cacheTtlMinutes == 0)
+        {
+            fprintf(stderr, "cacheTtlMinutes is invalid, using default: 360\n");
+            config.cacheTtlMinutes = 360;
+        }
+    }
+    else
+    {
+        fprintf(stderr, "cacheTtlMinutes not found or not a number in config\n");
+    }
+
+    // Read cacheMemoryLimitKb
+    cJSON* cache_memory_item = cJSON_GetObjectItem(json, "cacheMemoryLimitKb");
+    if (cJSON_IsNumber(cache_memory_item))
+    {
+        config.cacheMemoryLimitKb = (uint32_t)cache_memory_item->valuedouble;
+        if (config.cacheMemoryLimitKb == 0)
+        {
+            fprintf(stderr, "cacheMemoryLimitKb is invalid, using default: 512\n");
+            config.cacheMemoryLimitKb = 512;
+        }
+    }
+    else
+    {
+        fprintf(stderr, "cacheMemoryLimitKb not found or not a number in config\n");
+    }
+
+    // Read cacheFile
+    cJSON* cache_file_item = cJSON_GetObjectItem(json, "cacheFile");
+    if (cJSON_IsString(cache_file_item) && cache_file_item->valuestring != NULL)
+    {
+        config.cacheFile = strdup(cache_file_item->valuestring);
+        if (!config.cacheFile)
+        {
+            fprintf(stderr, "Failed to allocate memory for cacheFile\n");
+        }
+    }
+    else
+    {
+        fprintf(stderr, "cacheFile not found or not a string in config\n");
+    }
+
+    // Read daySwitchFadeMs
+    cJSON* day_switch_fade_item = cJSON_GetObjectItem(json, "daySwitchFadeMs");
+    if (cJSON_IsNumber(day_switch_fade_item))
+    {
+        config.daySwitchFadeMs = day_switch_fade_item->valuedouble > 0 ? (uint32_t)day_switch_fade_item->valuedouble : 0;
+    }
+    else
+    {
+        fprintf(stderr, "daySwitchFadeMs not found or not a number in config\n");
+    }
+
     cJSON_Delete(json);
     return config;
 }
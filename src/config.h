@@ -10,6 +10,12 @@ typedef struct
     char* roomId; // Room ID from config
     bool isDarkTheme; // Dark theme flag
     uint32_t inactiveDurationMs; // Inactivity duration in milliseconds
+    int prefetchDays; // Days fetched in the background before and after the displayed date
+    uint32_t cacheMaxAgeMinutes; // Minutes before a fetched day is fetched again in the background
+    uint32_t cacheTtlMinutes; // Minutes after which a cached day is marked stale and fetched again
+    uint32_t cacheMemoryLimitKb; // Memory limit of the schedule cache in kilobytes
+    char* cacheFile; // File the schedule cache is persisted to
+    uint32_t daySwitchFadeMs; // Duration of the fade-in of a newly displayed day, 0 to switch instantly
 } Config;
 
 // Function to read configuration from JSON file
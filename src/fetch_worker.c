@@ -0,0 +1,292 @@
+﻿#include "fetch_worker.h"
+#include "api.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Maximum number of fetches that may be queued, running or waiting to be polled
+#define FETCH_QUEUE_SIZE 32
+// Upper bound of a single wait for network activity
+#define FETCH_POLL_TIMEOUT_MS 1000
+
+typedef struct {
+    char* room_id;
+    struct tm date;
+    char* etag;
+    char* last_modified;
+    uint32_t tag;
+} fetch_request_t;
+
+static pthread_t worker_thread;
+static pthread_mutex_t queue_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queue_cond = PTHREAD_COND_INITIALIZER;
+static bool worker_running = false;
+
+// Request queue (LVGL thread -> worker)
+static fetch_request_t requests[FETCH_QUEUE_SIZE];
+static int request_head = 0;
+static int request_count = 0;
+
+// Completion queue (worker -> LVGL thread)
+static fetch_result_t results[FETCH_QUEUE_SIZE];
+static int result_head = 0;
+static int result_count = 0;
+
+// Requests submitted but not yet polled, bounds both queues
+static int outstanding = 0;
+// Requests handed over to the fetch engine
+static int active_fetches = 0;
+// Called once results are queued, set before the worker starts
+static void (*result_notify)(void) = NULL;
+
+static void free_request(fetch_request_t* request)
+{
+    free(request->room_id);
+    free(request->etag);
+    free(request->last_modified);
+}
+
+// Frees a request handed over to the fetch engine that was aborted before it finished
+static void cancel_request_callback(void* user_data)
+{
+    fetch_request_t* request = (fetch_request_t*)user_data;
+    free_request(request);
+    free(request);
+}
+
+static void fetch_done_callback(void* user_data, api_fetch_response_t* response)
+{
+    fetch_request_t* request = (fetch_request_t*)user_data;
+
+    fetch_result_t result = { 0 };
+    result.room_id = request->room_id;
+    result.date = request->date;
+    result.tag = request->tag;
+    result.status = response->status;
+    result.lessons = response->lessons;
+    result.etag = response->etag;
+    result.last_modified = response->last_modified;
+    free(request->etag);
+    free(request->last_modified);
+    free(request);
+
+    pthread_mutex_lock(&queue_mutex);
+    results[(result_head + result_count) % FETCH_QUEUE_SIZE] = result;
+    result_count++;
+    active_fetches--;
+    pthread_mutex_unlock(&queue_mutex);
+
+    if (result_notify)
+    {
+        result_notify();
+    }
+}
+
+static void* worker_main(void* arg)
+{
+    (void)arg;
+
+    pthread_mutex_lock(&queue_mutex);
+    while (true)
+    {
+        while (worker_running && request_count == 0 && active_fetches == 0)
+        {
+            pthread_cond_wait(&queue_cond, &queue_mutex);
+        }
+        if (!worker_running) break;
+
+        // Hand queued requests over to the fetch engine while it has free transfer slots
+        bool has_failed_requests = false;
+        while (request_count > 0)
+        {
+            fetch_request_t* request = malloc(sizeof(fetch_request_t));
+            if (request)
+            {
+                *request = requests[request_head];
+                if (api_start_fetch(request->room_id, &request->date, request->etag, request->last_modified,
+                        request) == 0)
+                {
+                    request_head = (request_head + 1) % FETCH_QUEUE_SIZE;
+                    request_count--;
+                    active_fetches++;
+                    continue;
+                }
+                free(request);
+            }
+
+            // Retry once a running transfer frees its slot
+            if (active_fetches > 0) break;
+
+            // The fetch engine cannot take the request at all, report it as failed
+            fetch_result_t result = { 0 };
+            result.room_id = requests[request_head].room_id;
+            result.date = requests[request_head].date;
+            result.tag = requests[request_head].tag;
+            result.status = -1;
+            free(requests[request_head].etag);
+            free(requests[request_head].last_modified);
+            request_head = (request_head + 1) % FETCH_QUEUE_SIZE;
+            request_count--;
+            results[(result_head + result_count) % FETCH_QUEUE_SIZE] = result;
+            result_count++;
+            has_failed_requests = true;
+        }
+        pthread_mutex_unlock(&queue_mutex);
+
+        if (has_failed_requests && result_notify)
+        {
+            result_notify();
+        }
+
+        // The network round trips happen without holding the queue lock
+        api_perform_fetches(FETCH_POLL_TIMEOUT_MS, fetch_done_callback);
+
+        pthread_mutex_lock(&queue_mutex);
+    }
+    active_fetches = 0;
+    pthread_mutex_unlock(&queue_mutex);
+
+    // Transfers still in flight belong to this thread, abort them before it exits
+    api_cancel_fetches(cancel_request_callback);
+
+    return NULL;
+}
+
+void fetch_worker_set_notify(void (*notify)(void))
+{
+    result_notify = notify;
+}
+
+int fetch_worker_start(void)
+{
+    pthread_mutex_lock(&queue_mutex);
+    if (worker_running)
+    {
+        pthread_mutex_unlock(&queue_mutex);
+        return 0;
+    }
+    worker_running = true;
+    pthread_mutex_unlock(&queue_mutex);
+
+    if (pthread_create(&worker_thread, NULL, worker_main, NULL) != 0)
+    {
+        fprintf(stderr, "Failed to create fetch worker thread\n");
+        pthread_mutex_lock(&queue_mutex);
+        worker_running = false;
+        pthread_mutex_unlock(&queue_mutex);
+        return -1;
+    }
+
+    return 0;
+}
+
+void fetch_worker_stop(void)
+{
+    pthread_mutex_lock(&queue_mutex);
+    if (!worker_running)
+    {
+        pthread_mutex_unlock(&queue_mutex);
+        return;
+    }
+    worker_running = false;
+    pthread_cond_signal(&queue_cond);
+    pthread_mutex_unlock(&queue_mutex);
+    api_wakeup();
+
+    // Waits for the current round of transfers to be driven and the remaining ones to be aborted
+    pthread_join(worker_thread, NULL);
+
+    while (request_count > 0)
+    {
+        free_request(&requests[request_head]);
+        request_head = (request_head + 1) % FETCH_QUEUE_SIZE;
+        request_count--;
+    }
+
+    fetch_result_t result;
+    while (fetch_worker_poll(&result))
+    {
+        free(result.room_id);
+        free(result.etag);
+        free(result.last_modified);
+        lesson_day_release(result.lessons);
+    }
+
+    outstanding = 0;
+}
+
+int fetch_worker_submit(const char* room_id, const struct tm* date, const char* etag, const char* last_modified,
+    bool urgent, uint32_t tag)
+{
+    if (!room_id || !date) return -1;
+
+    char* room_id_copy = strdup(room_id);
+    char* etag_copy = etag ? strdup(etag) : NULL;
+    char* last_modified_copy = last_modified ? strdup(last_modified) : NULL;
+    if (!room_id_copy || (etag && !etag_copy) || (last_modified && !last_modified_copy))
+    {
+        fprintf(stderr, "Failed to allocate memory for fetch request\n");
+        free(room_id_copy);
+        free(etag_copy);
+        free(last_modified_copy);
+        return -1;
+    }
+
+    pthread_mutex_lock(&queue_mutex);
+    if (!worker_running || outstanding >= FETCH_QUEUE_SIZE)
+    {
+        pthread_mutex_unlock(&queue_mutex);
+        free(room_id_copy);
+        free(etag_copy);
+        free(last_modified_copy);
+        return -1;
+    }
+
+    fetch_request_t* request;
+    if (urgent)
+    {
+        // Jump ahead of queued prefetches
+        request_head = (request_head + FETCH_QUEUE_SIZE - 1) % FETCH_QUEUE_SIZE;
+        request = &requests[request_head];
+    }
+    else
+    {
+        request = &requests[(request_head + request_count) % FETCH_QUEUE_SIZE];
+    }
+    request->room_id = room_id_copy;
+    request->date = *date;
+    request->etag = etag_copy;
+    request->last_modified = last_modified_copy;
+    request->tag = tag;
+    request_count++;
+    outstanding++;
+
+    pthread_cond_signal(&queue_cond);
+    pthread_mutex_unlock(&queue_mutex);
+
+    // Let a worker waiting for network activity pick the request up
+    api_wakeup();
+
+    return 0;
+}
+
+bool fetch_worker_poll(fetch_result_t* result)
+{
+    if (!result) return false;
+
+    pthread_mutex_lock(&queue_mutex);
+    if (result_count == 0)
+    {
+        pthread_mutex_unlock(&queue_mutex);
+        return false;
+    }
+
+    *result = results[result_head];
+    result_head = (result_head + 1) % FETCH_QUEUE_SIZE;
+    result_count--;
+    outstanding--;
+    pthread_mutex_unlock(&queue_mutex);
+
+    return true;
+}
@@ -0,0 +1,65 @@
+﻿#ifndef FETCH_WORKER_H
+#define FETCH_WORKER_H
+
+#include "lesson_day.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+/**
+ * Result of a background schedule fetch.
+ * Ownership of room_id, lessons and validators passes to the caller of fetch_worker_poll().
+ */
+typedef struct {
+    char* room_id;          /* Room the schedule was fetched for */
+    struct tm date;         /* Date the schedule was fetched for */
+    lesson_day_t* lessons;  /* Fetched lessons (NULL on failure) */
+    char* etag;             /* Validators of the response, NULL if absent */
+    char* last_modified;
+    int status;             /* 0 on success, API_FETCH_NOT_MODIFIED if unchanged, -1 on failure */
+    uint32_t tag;           /* Value given to fetch_worker_submit() */
+} fetch_result_t;
+
+/**
+ * Sets a function called from the worker thread whenever a completed fetch is ready to be polled,
+ * e.g. to wake up the LVGL thread instead of waiting for its next poll.
+ * @param notify Function to call, NULL to disable; must be safe to call from any thread.
+ * @note Call before fetch_worker_start().
+ */
+void fetch_worker_set_notify(void (*notify)(void));
+
+/**
+ * Starts the background fetch thread.
+ * @note api_init() must have been called first.
+ * @return 0 on success, -1 on error.
+ */
+int fetch_worker_start(void);
+
+/**
+ * Stops the background fetch thread and drops all queued requests and unpolled results.
+ */
+void fetch_worker_stop(void);
+
+/**
+ * Queues a schedule fetch for the given room and date.
+ * Queued fetches run in parallel, up to the number of transfer slots of the fetch engine.
+ * @param room_id Pointer to a string containing the room ID.
+ * @param date    Pointer to a struct tm containing the date to fetch (year, month, day).
+ * @param etag          ETag of the cached schedule for a conditional request, NULL if unknown.
+ * @param last_modified Last-Modified date of the cached schedule, NULL if unknown.
+ * @param urgent  true to start the fetch before all queued ones (e.g. the date shown to the user).
+ * @param tag     Value returned with the result, e.g. to tell which cache entry issued the fetch.
+ * @return 0 if the request was queued, -1 if the queue is full or the worker is not running.
+ */
+int fetch_worker_submit(const char* room_id, const struct tm* date, const char* etag, const char* last_modified,
+    bool urgent, uint32_t tag);
+
+/**
+ * Takes the next completed fetch, if any.
+ * @param result Pointer to a fetch_result_t that receives the completed fetch.
+ * @return true if a result was returned, false if no fetch has completed yet.
+ * @note Never blocks; intended to be called from the LVGL thread.
+ */
+bool fetch_worker_poll(fetch_result_t* result);
+
+#endif
@@ -0,0 +1,392 @@
+﻿#include "lesson_card.h"
+#include <lvgl/lvgl_private.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BAR_HEIGHT 30
+#define TIME_PADDING 5 // Horizontal distance between the times and the ends of the bar
+#define TYPE_PADDING 5
+#define SUBJECT_PADDING_TOP 5
+#define SUBJECT_PADDING_BOTTOM 10
+#define PERSON_WIDTH_PCT 45 // Width of the teacher and groups columns, in percent of the content
+#define PROGRESS_ANIM_MS 200 // Same as the default animation time of lv_bar
+
+// A text broken into the lines that fit the width it was laid out for
+typedef struct {
+    char* lines;            // The lines one after the other, each terminated by '\0'
+    int32_t line_count;
+} text_lines_t;
+
+typedef struct {
+    lv_obj_t obj;
+    lesson_t lesson;        // Strings are borrowed from the lesson snapshot
+    bool has_lesson;
+    bool has_progress;      // A progress was set for the lesson, later changes are animated
+    int progress;
+    int32_t shown_progress; // Progress drawn, follows progress during the animation
+    char start_time[8];     // "HH:MM", sized for any uint16_t minute
+    char end_time[8];
+    int32_t layout_width;   // Content width the lines below were broken for, -1 if stale
+    text_lines_t type;
+    text_lines_t subject;
+    text_lines_t teacher;
+    text_lines_t groups;
+    int32_t type_height;
+    int32_t subject_height;
+    int32_t people_height;  // Height of the taller of the teacher and groups texts
+} lesson_card_t;
+
+static void lesson_card_constructor(const lv_obj_class_t* class_p, lv_obj_t* obj);
+static void lesson_card_destructor(const lv_obj_class_t* class_p, lv_obj_t* obj);
+static void lesson_card_event(const lv_obj_class_t* class_p, lv_event_t* event);
+static void progress_anim_cb(void* var, int32_t value);
+
+const lv_obj_class_t lesson_card_class = {
+    .base_class = &lv_obj_class,
+    .constructor_cb = lesson_card_constructor,
+    .destructor_cb = lesson_card_destructor,
+    .event_cb = lesson_card_event,
+    .width_def = LV_PCT(100),
+    .height_def = LV_SIZE_CONTENT,
+    .instance_size = sizeof(lesson_card_t),
+};
+
+static void lesson_card_constructor(const lv_obj_class_t* class_p, lv_obj_t* obj)
+{
+    LV_UNUSED(class_p);
+
+    lesson_card_t* card = (lesson_card_t*)obj;
+    card->layout_width = -1;
+    lv_obj_remove_flag(obj, LV_OBJ_FLAG_SCROLLABLE);
+}
+
+static void clear_text_lines(text_lines_t* text_lines)
+{
+    free(text_lines->lines);
+    text_lines->lines = NULL;
+    text_lines->line_count = 0;
+}
+
+static void clear_layout(lesson_card_t* card)
+{
+    clear_text_lines(&card->type);
+    clear_text_lines(&card->subject);
+    clear_text_lines(&card->teacher);
+    clear_text_lines(&card->groups);
+    card->layout_width = -1;
+}
+
+// Breaks a text into the lines lv_draw_label() would wrap it into at a width
+static void break_text(text_lines_t* text_lines, const char* text, const lv_font_t* font, int32_t max_width)
+{
+    clear_text_lines(text_lines);
+    if (!text || text[0] == '\0') return;
+
+    // Every line gains a terminator and holds at least one byte
+    size_t length = strlen(text);
+    char* lines = malloc(2 * length + 1);
+    if (!lines)
+    {
+        fprintf(stderr, "Failed to allocate memory for lesson card text\n");
+        return;
+    }
+
+    char* line = lines;
+    size_t offset = 0;
+    while (text[offset] != '\0')
+    {
+        uint32_t line_length = lv_text_get_next_line(&text[offset], font, 0, max_width, NULL, LV_TEXT_FLAG_NONE);
+        if (line_length == 0) break;
+
+        // The line break itself is not drawn
+        uint32_t drawn_length = line_length;
+        while (drawn_length > 0 && (text[offset + drawn_length - 1] == '\n' || text[offset + drawn_length - 1] == '\r'))
+        {
+            drawn_length--;
+        }
+        memcpy(line, &text[offset], drawn_length);
+        line += drawn_length;
+        *line++ = '\0';
+        text_lines->line_count++;
+        offset += line_length;
+    }
+    text_lines->lines = lines;
+}
+
+// Breaks the texts into lines for the current width, unless they were broken for it already
+static void update_layout(lesson_card_t* card)
+{
+    lv_obj_t* obj = (lv_obj_t*)card;
+    int32_t width = lv_obj_get_content_width(obj);
+    if (card->layout_width == width) return;
+    card->layout_width = width;
+
+    const lv_font_t* font = lv_obj_get_style_text_font(obj, LV_PART_MAIN);
+    int32_t line_height = lv_font_get_line_height(font);
+    int32_t person_width = width * PERSON_WIDTH_PCT / 100;
+    break_text(&card->type, card->lesson.type, font, width - 2 * TYPE_PADDING);
+    break_text(&card->subject, card->lesson.subject, font, width);
+    break_text(&card->teacher, card->lesson.teacher, font, person_width);
+    break_text(&card->groups, card->lesson.groups, font, person_width);
+
+    card->type_height = card->type.line_count * line_height + 2 * TYPE_PADDING;
+    card->subject_height = card->subject.line_count * line_height + SUBJECT_PADDING_TOP + SUBJECT_PADDING_BOTTOM;
+    card->people_height = LV_MAX(card->teacher.line_count, card->groups.line_count) * line_height;
+}
+
+static int32_t get_content_height(lesson_card_t* card)
+{
+    if (!card->has_lesson) return 0;
+
+    update_layout(card);
+    int32_t row_gap = lv_obj_get_style_pad_row((lv_obj_t*)card, LV_PART_MAIN);
+    int32_t line_width = lv_obj_get_style_line_width((lv_obj_t*)card, LV_PART_MAIN);
+    return BAR_HEIGHT + card->type_height + card->subject_height + line_width + card->people_height + 4 * row_gap;
+}
+
+// Area of the progress bar, at the top of the content
+static void get_bar_area(lv_obj_t* obj, lv_area_t* area)
+{
+    lv_obj_get_content_coords(obj, area);
+    area->y2 = area->y1 + BAR_HEIGHT - 1;
+}
+
+static void draw_text(lv_layer_t* layer, lv_draw_label_dsc_t* dsc, const char* text, const lv_area_t* area)
+{
+    if (!text || text[0] == '\0') return;
+
+    dsc->text = text;
+    lv_draw_label(layer, dsc, area);
+}
+
+// Draws the lines of a text from the top of an area. Lines outside the area being redrawn,
+// e.g. everything but the bar during a progress update, are not handed to lv_draw_label().
+static void draw_lines(lv_layer_t* layer, lv_draw_label_dsc_t* dsc, const text_lines_t* text_lines, const lv_area_t* area)
+{
+    int32_t line_height = lv_font_get_line_height(dsc->font);
+    lv_area_t line_area = *area;
+    const char* line = text_lines->lines;
+    for (int32_t i = 0; i < text_lines->line_count; i++)
+    {
+        line_area.y1 = area->y1 + i * line_height;
+        line_area.y2 = line_area.y1 + line_height - 1;
+        lv_area_t clipped_area;
+        if (lv_area_intersect(&clipped_area, &line_area, &layer->_clip_area))
+        {
+            draw_text(layer, dsc, line, &line_area);
+        }
+        line += strlen(line) + 1;
+    }
+}
+
+static void draw_card(lesson_card_t* card, lv_layer_t* layer)
+{
+    if (!card->has_lesson) return;
+
+    lv_obj_t* obj = (lv_obj_t*)card;
+    update_layout(card);
+
+    const lv_font_t* font = lv_obj_get_style_text_font(obj, LV_PART_MAIN);
+    int32_t line_height = lv_font_get_line_height(font);
+    int32_t row_gap = lv_obj_get_style_pad_row(obj, LV_PART_MAIN);
+    lv_area_t content;
+    lv_obj_get_content_coords(obj, &content);
+
+    lv_draw_rect_dsc_t rect_dsc;
+    lv_draw_rect_dsc_init(&rect_dsc);
+    lv_draw_label_dsc_t label_dsc;
+    lv_draw_label_dsc_init(&label_dsc);
+    label_dsc.font = font;
+
+    // Progress bar
+    lv_area_t area;
+    get_bar_area(obj, &area);
+    rect_dsc.bg_color = lv_obj_get_style_bg_color(obj, LV_PART_ITEMS);
+    lv_draw_rect(layer, &rect_dsc, &area);
+    if (card->shown_progress > 0)
+    {
+        lv_area_t indicator_area = area;
+        indicator_area.x2 = area.x1 + lv_area_get_width(&area) * card->shown_progress / 100 - 1;
+        rect_dsc.bg_color = lv_obj_get_style_bg_color(obj, LV_PART_INDICATOR);
+        lv_draw_rect(layer, &rect_dsc, &indicator_area);
+    }
+
+    // Start and end times over the bar
+    lv_area_t text_area = area;
+    text_area.x1 += TIME_PADDING;
+    text_area.x2 -= TIME_PADDING;
+    text_area.y1 = area.y1 + (BAR_HEIGHT - line_height) / 2 - 1;
+    text_area.y2 = text_area.y1 + line_height - 1;
+    label_dsc.color = lv_obj_get_style_text_color(obj, LV_PART_INDICATOR);
+    label_dsc.align = LV_TEXT_ALIGN_LEFT;
+    draw_text(layer, &label_dsc, card->start_time, &text_area);
+    label_dsc.align = LV_TEXT_ALIGN_RIGHT;
+    draw_text(layer, &label_dsc, card->end_time, &text_area);
+
+    // Type badge
+    area.y1 = area.y2 + 1 + row_gap;
+    area.y2 = area.y1 + card->type_height - 1;
+    rect_dsc.bg_color = lv_color_hex(card->lesson.color);
+    lv_draw_rect(layer, &rect_dsc, &area);
+    text_area = area;
+    lv_area_increase(&text_area, -TYPE_PADDING, -TYPE_PADDING);
+    label_dsc.color = lv_color_white();
+    label_dsc.align = LV_TEXT_ALIGN_CENTER;
+    draw_lines(layer, &label_dsc, &card->type, &text_area);
+
+    // Subject
+    area.y1 = area.y2 + 1 + row_gap;
+    area.y2 = area.y1 + card->subject_height - 1;
+    text_area = area;
+    text_area.y1 += SUBJECT_PADDING_TOP;
+    text_area.y2 -= SUBJECT_PADDING_BOTTOM;
+    label_dsc.color = lv_obj_get_style_text_color(obj, LV_PART_MAIN);
+    label_dsc.align = LV_TEXT_ALIGN_LEFT;
+    draw_lines(layer, &label_dsc, &card->subject, &text_area);
+
+    // Dashed separator
+    int32_t line_width = lv_obj_get_style_line_width(obj, LV_PART_MAIN);
+    lv_draw_line_dsc_t line_dsc;
+    lv_draw_line_dsc_init(&line_dsc);
+    line_dsc.color = lv_obj_get_style_line_color(obj, LV_PART_MAIN);
+    line_dsc.width = line_width;
+    line_dsc.dash_width = lv_obj_get_style_line_dash_width(obj, LV_PART_MAIN);
+    line_dsc.dash_gap = lv_obj_get_style_line_dash_gap(obj, LV_PART_MAIN);
+    line_dsc.p1.x = content.x1;
+    line_dsc.p1.y = area.y2 + 1 + row_gap;
+    line_dsc.p2.x = content.x2;
+    line_dsc.p2.y = line_dsc.p1.y;
+    lv_draw_line(layer, &line_dsc);
+
+    // Teacher and groups side by side
+    area.y1 = area.y2 + 1 + row_gap + line_width + row_gap;
+    area.y2 = area.y1 + card->people_height - 1;
+    int32_t person_width = lv_area_get_width(&content) * PERSON_WIDTH_PCT / 100;
+    text_area = area;
+    text_area.x2 = text_area.x1 + person_width - 1;
+    draw_lines(layer, &label_dsc, &card->teacher, &text_area);
+    text_area = area;
+    text_area.x1 = text_area.x2 - person_width + 1;
+    label_dsc.align = LV_TEXT_ALIGN_RIGHT;
+    draw_lines(layer, &label_dsc, &card->groups, &text_area);
+}
+
+static void lesson_card_destructor(const lv_obj_class_t* class_p, lv_obj_t* obj)
+{
+    LV_UNUSED(class_p);
+
+    lv_anim_delete(obj, progress_anim_cb);
+    clear_layout((lesson_card_t*)obj);
+}
+
+static void lesson_card_event(const lv_obj_class_t* class_p, lv_event_t* event)
+{
+    LV_UNUSED(class_p);
+
+    // The base class draws the background and the border
+    if (lv_obj_event_base(&lesson_card_class, event) != LV_RESULT_OK) return;
+
+    lv_event_code_t code = lv_event_get_code(event);
+    lv_obj_t* obj = lv_event_get_current_target(event);
+    lesson_card_t* card = (lesson_card_t*)obj;
+
+    if (code == LV_EVENT_GET_SELF_SIZE)
+    {
+        lv_point_t* size = lv_event_get_param(event);
+        size->y = LV_MAX(size->y, get_content_height(card));
+    }
+    else if (code == LV_EVENT_SIZE_CHANGED)
+    {
+        // The line breaks depend on the width
+        if (card->layout_width != lv_obj_get_content_width(obj))
+        {
+            lv_obj_refresh_self_size(obj);
+        }
+    }
+    else if (code == LV_EVENT_STYLE_CHANGED)
+    {
+        // The font may have changed
+        card->layout_width = -1;
+    }
+    else if (code == LV_EVENT_DRAW_MAIN)
+    {
+        draw_card(card, lv_event_get_layer(event));
+    }
+}
+
+lv_obj_t* lesson_card_create(lv_obj_t* parent)
+{
+    lv_obj_t* obj = lv_obj_class_create_obj(&lesson_card_class, parent);
+    lv_obj_class_init_obj(obj);
+    return obj;
+}
+
+void lesson_card_set_lesson(lv_obj_t* obj, const lesson_t* lesson)
+{
+    lesson_card_t* card = (lesson_card_t*)obj;
+
+    if (lesson)
+    {
+        card->lesson = *lesson;
+        card->has_lesson = true;
+        snprintf(card->start_time, sizeof(card->start_time), "%02d:%02d", lesson->start_minute / 60, lesson->start_minute % 60);
+        snprintf(card->end_time, sizeof(card->end_time), "%02d:%02d", lesson->end_minute / 60, lesson->end_minute % 60);
+    }
+    else
+    {
+        memset(&card->lesson, 0, sizeof(card->lesson));
+        card->has_lesson = false;
+    }
+
+    // A card bound to another lesson shows its progress at once instead of sliding from the old one
+    lv_anim_delete(obj, progress_anim_cb);
+    card->has_progress = false;
+    clear_layout(card);
+    lv_obj_refresh_self_size(obj);
+    lv_obj_invalidate(obj);
+}
+
+static void progress_anim_cb(void* var, int32_t value)
+{
+    lesson_card_t* card = var;
+    card->shown_progress = value;
+
+    lv_area_t bar_area;
+    get_bar_area((lv_obj_t*)card, &bar_area);
+    lv_obj_invalidate_area((lv_obj_t*)card, &bar_area);
+}
+
+void lesson_card_set_progress(lv_obj_t* obj, int progress)
+{
+    lesson_card_t* card = (lesson_card_t*)obj;
+    progress = LV_CLAMP(0, progress, 100);
+    if (card->has_progress && card->progress == progress) return;
+    card->progress = progress;
+
+    // A change of state restyles the whole card, otherwise only the bar is redrawn
+    if (progress == 100)
+    {
+        lv_obj_add_state(obj, LV_STATE_CHECKED);
+    }
+    else
+    {
+        lv_obj_remove_state(obj, LV_STATE_CHECKED);
+    }
+
+    if (!card->has_progress)
+    {
+        card->has_progress = true;
+        progress_anim_cb(card, progress);
+        return;
+    }
+
+    // Slide the bar to the new value, like lv_bar_set_value(..., LV_ANIM_ON)
+    lv_anim_t anim;
+    lv_anim_init(&anim);
+    lv_anim_set_var(&anim, card);
+    lv_anim_set_exec_cb(&anim, progress_anim_cb);
+    lv_anim_set_values(&anim, card->shown_progress, progress);
+    lv_anim_set_duration(&anim, PROGRESS_ANIM_MS);
+    lv_anim_start(&anim);
+}
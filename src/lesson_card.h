@@ -0,0 +1,43 @@
+﻿#ifndef LESSON_CARD_H
+#define LESSON_CARD_H
+
+#include "lesson_day.h"
+#include <lvgl/lvgl.h>
+
+/**
+ * A single object drawing a whole lesson: the progress bar with the start and end times,
+ * the type badge, the wrapped subject, a dashed separator and the teacher and groups.
+ * The texts are broken into lines once per lesson and width, drawing reuses the lines.
+ *
+ * Styles are read from the card:
+ *   LV_PART_MAIN       background, border, padding, row gap, font, text color and separator line
+ *   LV_PART_ITEMS      background color of the progress bar
+ *   LV_PART_INDICATOR  color of the progress and text color of the times;
+ *                      a finished lesson is in the LV_STATE_CHECKED state
+ */
+extern const lv_obj_class_t lesson_card_class;
+
+/**
+ * Creates an empty lesson card.
+ * @param parent Pointer to the parent object.
+ * @return The new card.
+ */
+lv_obj_t* lesson_card_create(lv_obj_t* parent);
+
+/**
+ * Shows a lesson on a card.
+ * @param card   Pointer to the card.
+ * @param lesson Pointer to the lesson, NULL to empty the card. Its strings are not copied and
+ *               must stay valid while the card shows them.
+ */
+void lesson_card_set_lesson(lv_obj_t* card, const lesson_t* lesson);
+
+/**
+ * Sets the progress of the lesson on a card. A progress of 100 puts the card in the LV_STATE_CHECKED state.
+ * The first progress of a lesson is shown at once, later changes are animated.
+ * @param card     Pointer to the card.
+ * @param progress Progress in percent, 0 to 100.
+ */
+void lesson_card_set_progress(lv_obj_t* card, int progress);
+
+#endif
@@ -0,0 +1,88 @@
+﻿#include "lesson_day.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Bytes per lesson: the 32-bit arrays come first so that every array stays aligned
+#define LESSON_SIZE (5 * sizeof(uint32_t) + 2 * sizeof(uint16_t))
+
+static size_t block_size(int count)
+{
+    return sizeof(lesson_day_t) + (size_t)count * LESSON_SIZE;
+}
+
+lesson_day_t* lesson_day_create(int count)
+{
+    if (count < 0) return NULL;
+
+    lesson_day_t* day = malloc(block_size(count));
+    if (!day)
+    {
+        fprintf(stderr, "Failed to allocate memory for %d lessons\n", count);
+        return NULL;
+    }
+
+    size_t n = (size_t)count;
+    day->count = count;
+    day->refs = 1;
+    day->colors = (uint32_t*)(day + 1);
+    day->types = day->colors + n;
+    day->subjects = day->types + n;
+    day->teachers = day->subjects + n;
+    day->groups = day->teachers + n;
+    day->start_minutes = (uint16_t*)(day->groups + n);
+    day->end_minutes = day->start_minutes + n;
+    return day;
+}
+
+const lesson_day_t* lesson_day_retain(const lesson_day_t* day)
+{
+    if (day)
+    {
+        // The reference count is the only field that changes after a day is published
+        __atomic_add_fetch(&((lesson_day_t*)day)->refs, 1, __ATOMIC_RELAXED);
+    }
+    return day;
+}
+
+void lesson_day_release(const lesson_day_t* day)
+{
+    if (day && __atomic_sub_fetch(&((lesson_day_t*)day)->refs, 1, __ATOMIC_ACQ_REL) == 0)
+    {
+        free((lesson_day_t*)day);
+    }
+}
+
+int lesson_day_count(const lesson_day_t* day)
+{
+    return day ? day->count : 0;
+}
+
+lesson_t lesson_day_get(const lesson_day_t* day, int index)
+{
+    lesson_t lesson;
+    lesson.type = string_pool_get(day->types[index]);
+    lesson.subject = string_pool_get(day->subjects[index]);
+    lesson.teacher = string_pool_get(day->teachers[index]);
+    lesson.groups = string_pool_get(day->groups[index]);
+    lesson.color = day->colors[index];
+    lesson.start_minute = day->start_minutes[index];
+    lesson.end_minute = day->end_minutes[index];
+    return lesson;
+}
+
+bool lesson_day_equal(const lesson_day_t* a, const lesson_day_t* b)
+{
+    int count = lesson_day_count(a);
+    if (count != lesson_day_count(b)) return false;
+    if (count == 0) return true;
+
+    // Pooled strings are equal exactly when their references are, so the arrays compare as plain memory
+    size_t n = (size_t)count;
+    return memcmp(a->colors, b->colors, n * LESSON_SIZE) == 0;
+}
+
+size_t lesson_day_memory_size(const lesson_day_t* day)
+{
+    return day ? block_size(day->count) : 0;
+}
@@ -0,0 +1,93 @@
+﻿#ifndef LESSON_DAY_H
+#define LESSON_DAY_H
+
+#include "string_pool.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Read-only view of a single lesson in the schedule.
+ * Contains information about the lesson type, subject, teacher, and time.
+ * The strings are owned by the schedule data and stay valid for the lifetime of the process.
+ */
+typedef struct {
+    const char* type;       /* Type of the lesson */
+    const char* subject;    /* Subject of the lesson */
+    const char* teacher;    /* Name of the teacher */
+    const char* groups;     /* Groups of the lesson */
+    uint32_t color;         /* Background color for the lesson type */
+    uint16_t start_minute;  /* Start time in minutes since midnight */
+    uint16_t end_minute;    /* End time in minutes since midnight */
+} lesson_t;
+
+/**
+ * Lessons of one day in a compact structure-of-arrays layout, allocated as a single block.
+ * Times are minutes since midnight and strings are references into the string pool,
+ * so a lesson takes 24 bytes and time scans touch only the two minute arrays.
+ * A day is filled once by its creator and is immutable once published; it is shared
+ * by reference counting, so a reader keeps a snapshot alive while the cache moves on.
+ */
+typedef struct {
+    int count;                  /* Number of lessons */
+    int refs;                   /* Reference count, updated atomically */
+    uint32_t* colors;           /* Background color of each lesson type */
+    string_ref_t* types;        /* Lesson type names */
+    string_ref_t* subjects;     /* Subjects */
+    string_ref_t* teachers;     /* Teacher names */
+    string_ref_t* groups;       /* Group names */
+    uint16_t* start_minutes;    /* Start times in minutes since midnight */
+    uint16_t* end_minutes;      /* End times in minutes since midnight */
+} lesson_day_t;
+
+/**
+ * Allocates a day with room for a number of lessons; the arrays are left to be filled.
+ * @param count Number of lessons.
+ * @return The new day holding one reference, or NULL if memory could not be allocated.
+ */
+lesson_day_t* lesson_day_create(int count);
+
+/**
+ * Takes a reference to a day. Safe to call from any thread.
+ * @param day Pointer to the day, may be NULL.
+ * @return The same day.
+ */
+const lesson_day_t* lesson_day_retain(const lesson_day_t* day);
+
+/**
+ * Drops a reference to a day, freeing it with all of its arrays when it was the last one.
+ * Safe to call from any thread.
+ * @param day Pointer to the day, may be NULL.
+ */
+void lesson_day_release(const lesson_day_t* day);
+
+/**
+ * Gets the number of lessons of a day.
+ * @param day Pointer to the day, may be NULL.
+ * @return The number of lessons, 0 for NULL.
+ */
+int lesson_day_count(const lesson_day_t* day);
+
+/**
+ * Builds a read-only view of a lesson.
+ * @param day   Pointer to the day.
+ * @param index Index of the lesson, must be below lesson_day_count().
+ * @return The lesson with its strings resolved from the string pool.
+ */
+lesson_t lesson_day_get(const lesson_day_t* day, int index);
+
+/**
+ * Compares the lessons of two days.
+ * @param a Pointer to the first day, may be NULL.
+ * @param b Pointer to the second day, may be NULL.
+ * @return true if both days hold the same lessons in the same order.
+ */
+bool lesson_day_equal(const lesson_day_t* a, const lesson_day_t* b);
+
+/**
+ * Gets the memory held by a day.
+ * @param day Pointer to the day, may be NULL.
+ * @return The size of the block of the day in bytes.
+ */
+size_t lesson_day_memory_size(const lesson_day_t* day);
+
+#endif
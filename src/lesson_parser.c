@@ -0,0 +1,724 @@
+﻿#include "lesson_parser.h"
+#include "string_pool.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Keys longer than the longest recognized one are skipped
+#define MAX_KEY_LENGTH 15
+// Background color of lessons of an unknown type
+#define DEFAULT_LESSON_COLOR 0xCCCCCC
+
+// Fields of a schedule item that are kept
+typedef enum {
+    FIELD_TYPE,
+    FIELD_GROUPS,
+    FIELD_TEACHER,
+    FIELD_PERIOD,
+    FIELD_SUBJECT,
+    FIELD_COUNT,
+    FIELD_NONE = -1
+} lesson_field_t;
+
+static const char* const field_names[FIELD_COUNT] = { "Type", "Groups", "Teacher", "Period", "Subject" };
+
+// JSON value received for a field
+typedef enum {
+    VALUE_MISSING,
+    VALUE_NULL,
+    VALUE_STRING,
+    VALUE_OTHER
+} value_kind_t;
+
+typedef enum {
+    STATE_EXPECT_ARRAY,     /* Before the opening bracket of the response */
+    STATE_EXPECT_ITEM,      /* After the opening bracket or a comma between items */
+    STATE_NEXT_ITEM,        /* After an item, expecting a comma or the closing bracket */
+    STATE_EXPECT_KEY,       /* After the opening brace or a comma between fields */
+    STATE_KEY,              /* Inside a key */
+    STATE_EXPECT_COLON,     /* After a key */
+    STATE_EXPECT_VALUE,     /* After a colon */
+    STATE_STRING,           /* Inside a string value */
+    STATE_LITERAL,          /* Inside a number, true, false or null */
+    STATE_NESTED,           /* Inside an object or array that is skipped */
+    STATE_NEXT_FIELD,       /* After a value, expecting a comma or the closing brace */
+    STATE_DONE,             /* After the closing bracket of the response */
+    STATE_ERROR
+} parser_state_t;
+
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+} text_buffer_t;
+
+// Lesson of the response, packed into a lesson_day_t once the response is complete
+typedef struct {
+    string_ref_t type;
+    string_ref_t subject;
+    string_ref_t teacher;
+    string_ref_t groups;
+    uint32_t color;
+    uint16_t start_minute;
+    uint16_t end_minute;
+} parsed_lesson_t;
+
+struct lesson_parser {
+    parser_state_t state;
+    parser_state_t after_value;         /* State to return to once the current value ends */
+    lesson_field_t field;               /* Field receiving the current value, FIELD_NONE to discard it */
+    size_t offset;                      /* Bytes parsed so far, for error messages */
+    int item_index;                     /* Index of the current item in the response */
+
+    char key[MAX_KEY_LENGTH + 1];
+    size_t key_length;
+
+    // String decoding, kept across chunks
+    int escape;                         /* 0 outside escapes, 1 after a backslash, 2..5 inside \uXXXX */
+    uint32_t codepoint;                 /* Code point of the \u escape being read */
+    uint32_t high_surrogate;            /* First half of a surrogate pair, 0 if none */
+
+    char literal[6];                    /* Start of the literal being read, enough to recognize null */
+    size_t literal_length;
+
+    int nested_depth;                   /* Skipped object or array nesting */
+    bool nested_in_string;
+    bool nested_escape;
+
+    value_kind_t kinds[FIELD_COUNT];    /* Fields of the current item */
+    text_buffer_t texts[FIELD_COUNT];   /* String values of the current item, reused across items */
+
+    // Lessons of the response, reused across responses and copied into one block at the end
+    parsed_lesson_t* lessons;
+    int lesson_count;
+    int lesson_capacity;
+};
+
+// Dictionary of lesson types and their background colors.
+// Sorted by api_type in strcmp() (UTF-8 byte) order for the binary search in find_lesson_type().
+typedef struct {
+    const char* api_type;
+    const char* display_type;
+    uint32_t color;
+} lesson_type_t;
+
+static const lesson_type_t lesson_types[] = {
+    {"-", "-", 0x407ab2},
+    {"Доп.", "Дополнительная нагрузка", 0x276093},
+    {"К.сам.", "Контроль самостоятельной работы", 0x276093},
+    {"НИР", "НИР", 0x276093},
+    {"Пересдача", "Пересдача", 0x276093},
+    {"Рук.", "ГЭК, Консультации к диплому, руководство", 0x276093},
+    {"Сам.", "Самостоятельная работа студента", 0x276093},
+    {"гос.", "Госэкзамен", 0x276093},
+    {"дип.", "Дипломный проект", 0x276093},
+    {"диф.зач.", "Дифференцированный зачет", 0xe91e63},
+    {"зач.", "Зачет", 0xe91e63},
+    {"инд.", "Консультация индивидуальная", 0x276093},
+    {"кн.р.", "Контрольная работа", 0x276093},
+    {"конс.д.", "Консультация по дисциплине", 0x3e8470},
+    {"конс.эк.", "Консультация к промежуточной аттестации", 0x9e5fa1},
+    {"курс.пр.", "Курсовой проект", 0x276093},
+    {"курс.р.", "Курсовая работа", 0x407ab2},
+    {"лаб.", "Лабораторные занятия", 0x3e8470},
+    {"лек.", "Лекции", 0x276093},
+    {"прак.", "Практика", 0xe91e63},
+    {"практ.зан.  и семин.", "Практические занятия и семинары", 0xff8f00},
+    {"экз.", "Экзамен", 0xe91e63},
+};
+
+#define LESSON_TYPE_COUNT (sizeof(lesson_types) / sizeof(lesson_types[0]))
+
+// Pooled names of the dictionary, resolved once by the first lesson_parser_create()
+static string_ref_t lesson_type_refs[LESSON_TYPE_COUNT];
+static string_ref_t empty_ref = STRING_REF_INVALID;
+static string_ref_t dash_ref = STRING_REF_INVALID;
+
+static bool text_append(text_buffer_t* text, const char* bytes, size_t size)
+{
+    if (text->length + size + 1 > text->capacity)
+    {
+        size_t new_capacity = text->capacity ? text->capacity : 64;
+        while (new_capacity < text->length + size + 1)
+        {
+            new_capacity *= 2;
+        }
+        char* new_data = realloc(text->data, new_capacity);
+        if (!new_data) return false;
+        text->data = new_data;
+        text->capacity = new_capacity;
+    }
+    memcpy(text->data + text->length, bytes, size);
+    text->length += size;
+    text->data[text->length] = '\0';
+    return true;
+}
+
+static void fail(lesson_parser_t* parser, const char* reason)
+{
+    fprintf(stderr, "Failed to parse JSON at byte %zu: %s\n", parser->offset, reason);
+    parser->state = STATE_ERROR;
+}
+
+static bool is_whitespace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// Appends decoded bytes to the key or the field being read
+static bool put_bytes(lesson_parser_t* parser, const char* bytes, size_t size)
+{
+    if (parser->state == STATE_KEY)
+    {
+        for (size_t i = 0; i < size; i++)
+        {
+            if (parser->key_length < MAX_KEY_LENGTH)
+            {
+                parser->key[parser->key_length] = bytes[i];
+            }
+            parser->key_length++;
+        }
+        return true;
+    }
+
+    if (parser->field == FIELD_NONE) return true;
+    return text_append(&parser->texts[parser->field], bytes, size);
+}
+
+static bool put_codepoint(lesson_parser_t* parser, uint32_t codepoint)
+{
+    char bytes[4];
+    size_t size;
+    if (codepoint < 0x80)
+    {
+        bytes[0] = (char)codepoint;
+        size = 1;
+    }
+    else if (codepoint < 0x800)
+    {
+        bytes[0] = (char)(0xC0 | (codepoint >> 6));
+        bytes[1] = (char)(0x80 | (codepoint & 0x3F));
+        size = 2;
+    }
+    else if (codepoint < 0x10000)
+    {
+        bytes[0] = (char)(0xE0 | (codepoint >> 12));
+        bytes[1] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+        bytes[2] = (char)(0x80 | (codepoint & 0x3F));
+        size = 3;
+    }
+    else
+    {
+        bytes[0] = (char)(0xF0 | (codepoint >> 18));
+        bytes[1] = (char)(0x80 | ((codepoint >> 12) & 0x3F));
+        bytes[2] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+        bytes[3] = (char)(0x80 | (codepoint & 0x3F));
+        size = 4;
+    }
+    return put_bytes(parser, bytes, size);
+}
+
+// Replaces a high surrogate that is not followed by a low one
+static bool flush_surrogate(lesson_parser_t* parser)
+{
+    if (!parser->high_surrogate) return true;
+    parser->high_surrogate = 0;
+    return put_codepoint(parser, 0xFFFD);
+}
+
+static bool put_escaped_codepoint(lesson_parser_t* parser, uint32_t codepoint)
+{
+    if (codepoint >= 0xD800 && codepoint <= 0xDBFF)
+    {
+        if (!flush_surrogate(parser)) return false;
+        parser->high_surrogate = codepoint;
+        return true;
+    }
+    if (codepoint >= 0xDC00 && codepoint <= 0xDFFF)
+    {
+        if (!parser->high_surrogate) return put_codepoint(parser, 0xFFFD);
+        codepoint = 0x10000 + ((parser->high_surrogate - 0xD800) << 10) + (codepoint - 0xDC00);
+        parser->high_surrogate = 0;
+        return put_codepoint(parser, codepoint);
+    }
+    return flush_surrogate(parser) && put_codepoint(parser, codepoint);
+}
+
+static int hex_value(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Decodes one byte of a key or string value
+// Returns 1 at the closing quote, 0 to continue, -1 on error
+static int decode_string_byte(lesson_parser_t* parser, char c)
+{
+    if (parser->escape == 0)
+    {
+        if (c == '"') return flush_surrogate(parser) ? 1 : -1;
+        if (c == '\\')
+        {
+            parser->escape = 1;
+            return 0;
+        }
+        if ((unsigned char)c < 0x20) return -1;
+        return flush_surrogate(parser) && put_bytes(parser, &c, 1) ? 0 : -1;
+    }
+
+    if (parser->escape == 1)
+    {
+        char decoded;
+        switch (c)
+        {
+            case '"': decoded = '"'; break;
+            case '\\': decoded = '\\'; break;
+            case '/': decoded = '/'; break;
+            case 'b': decoded = '\b'; break;
+            case 'f': decoded = '\f'; break;
+            case 'n': decoded = '\n'; break;
+            case 'r': decoded = '\r'; break;
+            case 't': decoded = '\t'; break;
+            case 'u':
+                parser->escape = 2;
+                parser->codepoint = 0;
+                return 0;
+            default:
+                return -1;
+        }
+        parser->escape = 0;
+        return flush_surrogate(parser) && put_bytes(parser, &decoded, 1) ? 0 : -1;
+    }
+
+    int digit = hex_value(c);
+    if (digit < 0) return -1;
+    parser->codepoint = (parser->codepoint << 4) | (uint32_t)digit;
+    if (++parser->escape < 6) return 0;
+    parser->escape = 0;
+    return put_escaped_codepoint(parser, parser->codepoint) ? 0 : -1;
+}
+
+static lesson_field_t find_field(const lesson_parser_t* parser)
+{
+    if (parser->key_length > MAX_KEY_LENGTH) return FIELD_NONE;
+
+    for (int i = 0; i < FIELD_COUNT; i++)
+    {
+        if (strlen(field_names[i]) == parser->key_length &&
+            memcmp(field_names[i], parser->key, parser->key_length) == 0)
+        {
+            return (lesson_field_t)i;
+        }
+    }
+    return FIELD_NONE;
+}
+
+static bool is_field_empty(const lesson_parser_t* parser, lesson_field_t field)
+{
+    return parser->kinds[field] == VALUE_MISSING || parser->kinds[field] == VALUE_NULL ||
+           (parser->kinds[field] == VALUE_STRING && parser->texts[field].length == 0);
+}
+
+static const char* field_text(const lesson_parser_t* parser, lesson_field_t field)
+{
+    return parser->texts[field].data ? parser->texts[field].data : "";
+}
+
+static int compare_lesson_type(const void* key, const void* element)
+{
+    return strcmp((const char*)key, ((const lesson_type_t*)element)->api_type);
+}
+
+static const lesson_type_t* find_lesson_type(const char* api_type)
+{
+    return bsearch(api_type, lesson_types, LESSON_TYPE_COUNT, sizeof(lesson_type_t), compare_lesson_type);
+}
+
+// Pooled display name and color of the lesson type of the current item
+static string_ref_t resolve_type(const lesson_parser_t* parser, uint32_t* color)
+{
+    const char* api_type;
+    if (parser->kinds[FIELD_TYPE] == VALUE_MISSING || parser->kinds[FIELD_TYPE] == VALUE_NULL)
+    {
+        api_type = "-";
+    }
+    else if (parser->kinds[FIELD_TYPE] == VALUE_STRING)
+    {
+        api_type = field_text(parser, FIELD_TYPE);
+    }
+    else
+    {
+        return empty_ref;
+    }
+
+    const lesson_type_t* type = find_lesson_type(api_type);
+    if (!type) return string_pool_intern(api_type, strlen(api_type));
+
+    // Known types are never looked up in the string pool
+    *color = type->color;
+    return lesson_type_refs[type - lesson_types];
+}
+
+// Pooled value of a string field, "-" when it is empty
+static string_ref_t intern_field(const lesson_parser_t* parser, lesson_field_t field, bool is_empty)
+{
+    if (is_empty) return dash_ref;
+    return string_pool_intern(field_text(parser, field), parser->texts[field].length);
+}
+
+// Turns the current item into a lesson
+static bool emit_lesson(lesson_parser_t* parser)
+{
+    bool groups_empty = is_field_empty(parser, FIELD_GROUPS);
+    bool teacher_empty = is_field_empty(parser, FIELD_TEACHER);
+
+    // Skip if Type is null AND at least one of Groups or Teacher is empty
+    // OR if both Groups and Teacher are empty
+    if ((parser->kinds[FIELD_TYPE] == VALUE_NULL && (groups_empty || teacher_empty)) || (groups_empty && teacher_empty))
+    {
+        return true;
+    }
+
+    if (parser->lesson_count == parser->lesson_capacity)
+    {
+        int new_capacity = parser->lesson_capacity ? parser->lesson_capacity * 2 : 8;
+        parsed_lesson_t* new_lessons = realloc(parser->lessons, (size_t)new_capacity * sizeof(parsed_lesson_t));
+        if (!new_lessons)
+        {
+            fprintf(stderr, "Failed to allocate memory for lesson %d\n", parser->item_index);
+            return false;
+        }
+        parser->lessons = new_lessons;
+        parser->lesson_capacity = new_capacity;
+    }
+
+    parsed_lesson_t* lesson = &parser->lessons[parser->lesson_count];
+    lesson->color = DEFAULT_LESSON_COLOR;
+    lesson->start_minute = 0;
+    lesson->end_minute = 0;
+    lesson->type = empty_ref;
+    lesson->subject = empty_ref;
+    lesson->teacher = empty_ref;
+    lesson->groups = empty_ref;
+
+    // Time parsing ("HH:MM:SS-HH:MM:SS")
+    int start_hour, start_minute, end_hour, end_minute;
+    bool is_valid = parser->kinds[FIELD_PERIOD] == VALUE_STRING && parser->kinds[FIELD_SUBJECT] == VALUE_STRING &&
+                    parser->kinds[FIELD_GROUPS] == VALUE_STRING && parser->kinds[FIELD_TEACHER] == VALUE_STRING;
+    if (!is_valid)
+    {
+        fprintf(stderr, "Invalid JSON structure for lesson %d\n", parser->item_index);
+    }
+    else if (sscanf(field_text(parser, FIELD_PERIOD), "%02d:%02d:%*d-%02d:%02d:%*d",
+                 &start_hour, &start_minute, &end_hour, &end_minute) != 4 ||
+             start_hour < 0 || start_minute < 0 || end_hour < 0 || end_minute < 0)
+    {
+        fprintf(stderr, "Failed to parse period string for lesson %d: '%s'\n", parser->item_index,
+            field_text(parser, FIELD_PERIOD));
+        is_valid = false;
+    }
+
+    if (is_valid)
+    {
+        lesson->start_minute = (uint16_t)(start_hour * 60 + start_minute);
+        lesson->end_minute = (uint16_t)(end_hour * 60 + end_minute);
+        lesson->type = resolve_type(parser, &lesson->color);
+        lesson->subject = intern_field(parser, FIELD_SUBJECT, false);
+        lesson->teacher = intern_field(parser, FIELD_TEACHER, teacher_empty);
+        lesson->groups = intern_field(parser, FIELD_GROUPS, groups_empty);
+    }
+
+    if (lesson->type == STRING_REF_INVALID || lesson->subject == STRING_REF_INVALID ||
+        lesson->teacher == STRING_REF_INVALID || lesson->groups == STRING_REF_INVALID)
+    {
+        fprintf(stderr, "Memory allocation failed for lesson %d strings\n", parser->item_index);
+        return false;
+    }
+
+    parser->lesson_count++;
+    return true;
+}
+
+static void begin_item(lesson_parser_t* parser)
+{
+    for (int i = 0; i < FIELD_COUNT; i++)
+    {
+        parser->kinds[i] = VALUE_MISSING;
+        parser->texts[i].length = 0;
+        if (parser->texts[i].data) parser->texts[i].data[0] = '\0';
+    }
+}
+
+static void end_value(lesson_parser_t* parser, value_kind_t kind)
+{
+    if (parser->field != FIELD_NONE)
+    {
+        parser->kinds[parser->field] = kind;
+    }
+    parser->state = parser->after_value;
+}
+
+// Starts reading a value whose first byte is c
+static void begin_value(lesson_parser_t* parser, char c)
+{
+    if (parser->field != FIELD_NONE)
+    {
+        // A repeated key replaces the previous value
+        parser->texts[parser->field].length = 0;
+        if (parser->texts[parser->field].data) parser->texts[parser->field].data[0] = '\0';
+    }
+
+    if (c == '"')
+    {
+        parser->state = STATE_STRING;
+        parser->escape = 0;
+        parser->high_surrogate = 0;
+    }
+    else if (c == '{' || c == '[')
+    {
+        parser->state = STATE_NESTED;
+        parser->nested_depth = 1;
+        parser->nested_in_string = false;
+        parser->nested_escape = false;
+    }
+    else if (c == '-' || (c >= '0' && c <= '9') || c == 't' || c == 'f' || c == 'n')
+    {
+        parser->state = STATE_LITERAL;
+        parser->literal[0] = c;
+        parser->literal_length = 1;
+    }
+    else
+    {
+        fail(parser, "unexpected character");
+    }
+}
+
+// Consumes one byte of the nested value being skipped
+static void skip_nested_byte(lesson_parser_t* parser, char c)
+{
+    if (parser->nested_in_string)
+    {
+        if (parser->nested_escape) parser->nested_escape = false;
+        else if (c == '\\') parser->nested_escape = true;
+        else if (c == '"') parser->nested_in_string = false;
+        return;
+    }
+
+    if (c == '"') parser->nested_in_string = true;
+    else if (c == '{' || c == '[') parser->nested_depth++;
+    else if ((c == '}' || c == ']') && --parser->nested_depth == 0) end_value(parser, VALUE_OTHER);
+}
+
+// Processes one byte, returns false if the byte has to be processed again in the new state
+static bool parse_byte(lesson_parser_t* parser, char c)
+{
+    int result;
+
+    switch (parser->state)
+    {
+        case STATE_EXPECT_ARRAY:
+            if (is_whitespace(c)) break;
+            if (c == '[') parser->state = STATE_EXPECT_ITEM;
+            else fail(parser, "JSON response is not an array");
+            break;
+
+        case STATE_EXPECT_ITEM:
+            if (is_whitespace(c)) break;
+            if (c == ']')
+            {
+                parser->state = STATE_DONE;
+                break;
+            }
+            parser->item_index++;
+            if (c == '{')
+            {
+                begin_item(parser);
+                parser->state = STATE_EXPECT_KEY;
+                break;
+            }
+            // Items that are not objects hold no lesson
+            parser->field = FIELD_NONE;
+            parser->after_value = STATE_NEXT_ITEM;
+            begin_value(parser, c);
+            break;
+
+        case STATE_NEXT_ITEM:
+            if (is_whitespace(c)) break;
+            if (c == ',') parser->state = STATE_EXPECT_ITEM;
+            else if (c == ']') parser->state = STATE_DONE;
+            else fail(parser, "expected ',' or ']'");
+            break;
+
+        case STATE_EXPECT_KEY:
+            if (is_whitespace(c)) break;
+            if (c == '"')
+            {
+                parser->state = STATE_KEY;
+                parser->key_length = 0;
+                parser->escape = 0;
+                parser->high_surrogate = 0;
+            }
+            else if (c == '}')
+            {
+                if (!emit_lesson(parser)) parser->state = STATE_ERROR;
+                else parser->state = STATE_NEXT_ITEM;
+            }
+            else fail(parser, "expected a key");
+            break;
+
+        case STATE_KEY:
+            result = decode_string_byte(parser, c);
+            if (result < 0) fail(parser, "invalid key");
+            else if (result > 0) parser->state = STATE_EXPECT_COLON;
+            break;
+
+        case STATE_EXPECT_COLON:
+            if (is_whitespace(c)) break;
+            if (c == ':') parser->state = STATE_EXPECT_VALUE;
+            else fail(parser, "expected ':'");
+            break;
+
+        case STATE_EXPECT_VALUE:
+            if (is_whitespace(c)) break;
+            parser->field = find_field(parser);
+            parser->after_value = STATE_NEXT_FIELD;
+            begin_value(parser, c);
+            break;
+
+        case STATE_STRING:
+            result = decode_string_byte(parser, c);
+            if (result < 0) fail(parser, "invalid string");
+            else if (result > 0) end_value(parser, VALUE_STRING);
+            break;
+
+        case STATE_LITERAL:
+            if (c == ',' || c == '}' || c == ']' || is_whitespace(c))
+            {
+                bool is_null = parser->literal_length == 4 && memcmp(parser->literal, "null", 4) == 0;
+                end_value(parser, is_null ? VALUE_NULL : VALUE_OTHER);
+                return false;
+            }
+            if (parser->literal_length < sizeof(parser->literal)) parser->literal[parser->literal_length++] = c;
+            break;
+
+        case STATE_NESTED:
+            skip_nested_byte(parser, c);
+            break;
+
+        case STATE_NEXT_FIELD:
+            if (is_whitespace(c)) break;
+            if (c == ',') parser->state = STATE_EXPECT_KEY;
+            else if (c == '}')
+            {
+                if (!emit_lesson(parser)) parser->state = STATE_ERROR;
+                else parser->state = STATE_NEXT_ITEM;
+            }
+            else fail(parser, "expected ',' or '}'");
+            break;
+
+        case STATE_DONE:
+            if (!is_whitespace(c)) fail(parser, "unexpected data after the response");
+            break;
+
+        case STATE_ERROR:
+            break;
+    }
+
+    return true;
+}
+
+lesson_parser_t* lesson_parser_create(void)
+{
+    // The dictionary names are pooled once, before any parser runs
+    if (empty_ref == STRING_REF_INVALID)
+    {
+        for (size_t i = 0; i < LESSON_TYPE_COUNT; i++)
+        {
+            lesson_type_refs[i] = string_pool_intern(lesson_types[i].display_type, strlen(lesson_types[i].display_type));
+        }
+        dash_ref = string_pool_intern("-", 1);
+        empty_ref = string_pool_intern("", 0);
+    }
+
+    lesson_parser_t* parser = calloc(1, sizeof(lesson_parser_t));
+    if (!parser)
+    {
+        fprintf(stderr, "Failed to allocate memory for lesson parser\n");
+    }
+    return parser;
+}
+
+void lesson_parser_destroy(lesson_parser_t* parser)
+{
+    if (!parser) return;
+
+    for (int i = 0; i < FIELD_COUNT; i++)
+    {
+        free(parser->texts[i].data);
+    }
+    free(parser->lessons);
+    free(parser);
+}
+
+void lesson_parser_reset(lesson_parser_t* parser)
+{
+    // Buffers keep their capacity, so a steady stream of responses allocates nothing here
+    parser->lesson_count = 0;
+    parser->state = STATE_EXPECT_ARRAY;
+    parser->offset = 0;
+    parser->item_index = -1;
+}
+
+int lesson_parser_feed(lesson_parser_t* parser, const char* data, size_t size)
+{
+    for (size_t i = 0; i < size && parser->state != STATE_ERROR; )
+    {
+        if (parse_byte(parser, data[i]))
+        {
+            i++;
+            parser->offset++;
+        }
+    }
+    return parser->state == STATE_ERROR ? -1 : 0;
+}
+
+int lesson_parser_finish(lesson_parser_t* parser, lesson_day_t** lessons)
+{
+    if (parser->state != STATE_DONE)
+    {
+        if (parser->state != STATE_ERROR)
+        {
+            fail(parser, "response is incomplete");
+        }
+        lesson_parser_reset(parser);
+        return -1;
+    }
+
+    // The whole day goes into a single allocation
+    lesson_day_t* day = lesson_day_create(parser->lesson_count);
+    if (!day)
+    {
+        lesson_parser_reset(parser);
+        return -1;
+    }
+
+    for (int i = 0; i < parser->lesson_count; i++)
+    {
+        const parsed_lesson_t* lesson = &parser->lessons[i];
+        day->colors[i] = lesson->color;
+        day->types[i] = lesson->type;
+        day->subjects[i] = lesson->subject;
+        day->teachers[i] = lesson->teacher;
+        day->groups[i] = lesson->groups;
+        day->start_minutes[i] = lesson->start_minute;
+        day->end_minutes[i] = lesson->end_minute;
+    }
+
+    *lessons = day;
+    lesson_parser_reset(parser);
+    return 0;
+}
@@ -0,0 +1,52 @@
+﻿#ifndef LESSON_PARSER_H
+#define LESSON_PARSER_H
+
+#include "lesson_day.h"
+#include <stddef.h>
+
+/**
+ * Incremental parser of the schedule endpoint response.
+ * The JSON array is parsed as it is downloaded: only the Type, Groups, Teacher, Period
+ * and Subject fields of each item are kept, and every item is turned into a lesson
+ * as soon as its object is closed. Unknown fields are skipped without being stored.
+ */
+typedef struct lesson_parser lesson_parser_t;
+
+/**
+ * Creates a parser ready for a response.
+ * @return The new parser, or NULL if memory could not be allocated.
+ */
+lesson_parser_t* lesson_parser_create(void);
+
+/**
+ * Frees a parser and its buffers.
+ * @param parser Pointer to the parser, may be NULL.
+ */
+void lesson_parser_destroy(lesson_parser_t* parser);
+
+/**
+ * Prepares a parser for a new response, dropping any lessons of the previous one.
+ * The buffers of the parser are kept for reuse.
+ * @param parser Pointer to the parser.
+ */
+void lesson_parser_reset(lesson_parser_t* parser);
+
+/**
+ * Parses the next chunk of the response. Chunks may split tokens anywhere.
+ * @param parser Pointer to the parser.
+ * @param data   Pointer to the chunk.
+ * @param size   Number of bytes in the chunk.
+ * @return 0 on success, -1 if the response is malformed or memory ran out;
+ *         once an error occurred further chunks are ignored.
+ */
+int lesson_parser_feed(lesson_parser_t* parser, const char* data, size_t size);
+
+/**
+ * Completes the response and hands the parsed lessons over as a single block.
+ * @param parser   Pointer to the parser.
+ * @param lessons  Pointer that receives the lessons, release them with lesson_day_release().
+ * @return 0 on success, -1 if the response was malformed or incomplete.
+ */
+int lesson_parser_finish(lesson_parser_t* parser, lesson_day_t** lessons);
+
+#endif
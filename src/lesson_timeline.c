@@ -0,0 +1,99 @@
+﻿#include "lesson_timeline.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * The boundaries split the day into intervals: interval i runs from boundaries[i - 1]
+ * up to boundaries[i], with interval 0 before the first boundary and interval count
+ * after the last one. active[i] holds the lesson in progress during interval i.
+ */
+struct lesson_timeline {
+    int count;              /* Number of distinct boundaries */
+    int cursor;             /* Interval of the last query */
+    uint16_t* boundaries;   /* Sorted distinct start and end minutes */
+    int16_t* active;        /* Lesson in progress in each interval, -1 if none */
+};
+
+static int compare_minutes(const void* a, const void* b)
+{
+    return (int)*(const uint16_t*)a - (int)*(const uint16_t*)b;
+}
+
+lesson_timeline_t* lesson_timeline_create(const lesson_day_t* day)
+{
+    int lesson_count = lesson_day_count(day);
+    size_t max_boundaries = (size_t)lesson_count * 2;
+
+    // Single block: header, intervals (one more than there are boundaries), then boundaries
+    lesson_timeline_t* timeline = malloc(sizeof(lesson_timeline_t) +
+        max_boundaries * sizeof(uint16_t) + (max_boundaries + 1) * sizeof(int16_t));
+    if (!timeline)
+    {
+        fprintf(stderr, "Failed to allocate memory for lesson timeline\n");
+        return NULL;
+    }
+    timeline->active = (int16_t*)(timeline + 1);
+    timeline->boundaries = (uint16_t*)(timeline->active + max_boundaries + 1);
+    timeline->cursor = 0;
+
+    for (int i = 0; i < lesson_count; i++)
+    {
+        timeline->boundaries[2 * i] = day->start_minutes[i];
+        timeline->boundaries[2 * i + 1] = day->end_minutes[i];
+    }
+    qsort(timeline->boundaries, max_boundaries, sizeof(uint16_t), compare_minutes);
+
+    int count = 0;
+    for (size_t i = 0; i < max_boundaries; i++)
+    {
+        if (count == 0 || timeline->boundaries[count - 1] != timeline->boundaries[i])
+        {
+            timeline->boundaries[count++] = timeline->boundaries[i];
+        }
+    }
+    timeline->count = count;
+
+    // A day has only a handful of lessons, so each interval simply checks all of them
+    for (int interval = 0; interval <= count; interval++)
+    {
+        timeline->active[interval] = -1;
+        if (interval == 0 || interval == count) continue;
+
+        int minute = timeline->boundaries[interval - 1];
+        int latest_start = -1;
+        for (int i = 0; i < lesson_count; i++)
+        {
+            if (day->start_minutes[i] <= minute && minute < day->end_minutes[i] &&
+                day->start_minutes[i] > latest_start)
+            {
+                latest_start = day->start_minutes[i];
+                timeline->active[interval] = (int16_t)i;
+            }
+        }
+    }
+
+    return timeline;
+}
+
+void lesson_timeline_free(lesson_timeline_t* timeline)
+{
+    free(timeline);
+}
+
+int lesson_timeline_find(lesson_timeline_t* timeline, int minute)
+{
+    if (!timeline) return -1;
+
+    // Step back only if the clock went backwards, e.g. after a time adjustment or a new day
+    int interval = timeline->cursor;
+    while (interval > 0 && minute < timeline->boundaries[interval - 1])
+    {
+        interval--;
+    }
+    while (interval < timeline->count && minute >= timeline->boundaries[interval])
+    {
+        interval++;
+    }
+    timeline->cursor = interval;
+    return timeline->active[interval];
+}
@@ -0,0 +1,38 @@
+﻿#ifndef LESSON_TIMELINE_H
+#define LESSON_TIMELINE_H
+
+#include "lesson_day.h"
+
+/**
+ * Index of the start and end times of a day's lessons.
+ * The day is split at every boundary into sorted intervals, each knowing the lesson in progress,
+ * so that the current lesson is found without scanning the lessons.
+ * A lesson is in progress from its start minute up to, but excluding, its end minute.
+ * Where lessons overlap, the one that started last is reported.
+ */
+typedef struct lesson_timeline lesson_timeline_t;
+
+/**
+ * Builds the timeline of a day.
+ * @param day Pointer to the day, may be NULL for a day without lessons.
+ * @return The new timeline, or NULL if memory could not be allocated.
+ */
+lesson_timeline_t* lesson_timeline_create(const lesson_day_t* day);
+
+/**
+ * Frees a timeline.
+ * @param timeline Pointer to the timeline, may be NULL.
+ */
+void lesson_timeline_free(lesson_timeline_t* timeline);
+
+/**
+ * Finds the lesson in progress at a minute of the day.
+ * The timeline remembers the last interval found, so queries with non-decreasing minutes,
+ * such as a clock ticking forward, take constant time.
+ * @param timeline Pointer to the timeline, may be NULL.
+ * @param minute   Minute of the day.
+ * @return The index of the lesson in progress, or -1 if none.
+ */
+int lesson_timeline_find(lesson_timeline_t* timeline, int minute);
+
+#endif
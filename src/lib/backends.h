@@ -69,6 +69,9 @@ typedef struct {
 /* Prototype used to register a backend */
 typedef int (*backend_init_t)(backend_t *);
 
+/* Prototype of the function called when a watched file descriptor is readable or failed */
+typedef void (*fd_ready_cb_t)(int fd, void *user_data);
+
 /**********************
  * GLOBAL PROTOTYPES
  **********************/
@@ -84,6 +87,37 @@ int backend_init_x11(backend_t *backend);
 /* Input device driver backends */
 int backend_init_evdev(backend_t *backend);
 
+/* Shared event loop - implemented in driver_backends.c */
+
+/**
+ * Watch a file descriptor from the event loop
+ * @description the callback runs on the LVGL thread as soon as the fd is readable,
+ * it has to consume the data for the fd to stop being reported. It also runs once
+ * the fd reports an error or a hang-up, e.g. an unplugged device: the fd is no
+ * longer watched afterwards, the callback is expected to notice the failed read
+ * and close it
+ * @param fd the file descriptor to watch
+ * @param ready_cb called when the fd is readable or failed
+ * @param user_data passed to the callback
+ * @return 0 on success, -1 if the event loop is unavailable or full
+ */
+int driver_backends_watch_fd(int fd, fd_ready_cb_t ready_cb, void *user_data);
+
+/**
+ * Stop watching a file descriptor from the event loop
+ * @description the fd is not closed, safe to call from a ready callback
+ * @param fd the file descriptor passed to driver_backends_watch_fd
+ */
+void driver_backends_unwatch_fd(int fd);
+
+/**
+ * Run LVGL until the process exits
+ * @description blocks in epoll on the watched fds, a timerfd armed to the
+ * next LVGL timer deadline and an eventfd signaled by driver_backends_wakeup(),
+ * so the process only wakes up when there is something to do
+ */
+void driver_backends_event_loop(void);
+
 /**********************
  *      MACROS
  **********************/
@@ -102,15 +102,8 @@ static lv_display_t *init_fbdev(void)
  */
 static void run_loop_fbdev(void)
 {
-    uint32_t idle_time;
-
-    /* Handle LVGL tasks */
-    while (true) {
-
-        /* Returns the time to the next timer execution */
-        idle_time = lv_timer_handler();
-        usleep(idle_time * 1000);
-    }
+    /* Sleep until a timer is due or an input device has data */
+    driver_backends_event_loop();
 }
 
 #endif /*LV_USE_LINUX_FBDEV*/
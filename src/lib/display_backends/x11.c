@@ -111,14 +111,8 @@ static lv_display_t *init_x11(void)
  */
 void run_loop_x11(void)
 {
-    uint32_t idle_time;
-
-    /* Handle LVGL tasks */
-    while (true) {
-        /* Returns the time to the next timer execution */
-        idle_time = lv_timer_handler();
-        usleep(idle_time * 1000);
-    }
+    /* Sleep until a timer is due or an input device has data */
+    driver_backends_event_loop();
 }
 
 #endif /*#if LV_USE_X11*/
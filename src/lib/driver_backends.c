@@ -18,6 +18,10 @@
 #include <stdbool.h>
 #include <string.h>
 #include <ctype.h>
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
 
 #include "lvgl/lvgl.h"
 
@@ -26,6 +30,7 @@
 #include "driver_backends.h"
 
 #include "backends.h"
+#include "refresh_governor.h"
 
 /*********************
  *      DEFINES
@@ -42,14 +47,30 @@
 #error Unsupported configuration - Please select at least one graphics backend in lv_conf.h
 #endif
 
+/* Maximum number of file descriptors watched by the event loop, including its own */
+#define MAX_WATCHED_FDS 16
+
 /**********************
  *      TYPEDEFS
  **********************/
 
+/* A file descriptor watched by the event loop */
+typedef struct {
+    int fd;                 /* -1 once the slot is free */
+    fd_ready_cb_t ready_cb;
+    void *user_data;
+} watched_fd_t;
+
 /**********************
  *  STATIC PROTOTYPES
  **********************/
 
+static void event_loop_init(void);
+static void sleep_loop(void);
+static void arm_timer_fd(uint32_t idle_time);
+static void drain_fd(int fd, void *user_data);
+static void wakeup_ready_cb(int fd, void *user_data);
+
 /**********************
  *  STATIC VARIABLES
  **********************/
@@ -96,6 +117,14 @@ static backend_t *backends[sizeof(available_backends) / sizeof(available_backend
 /* Set once the user selects a backend - or it is set to the default backend */
 static backend_t *sel_display_backend = NULL;
 
+/* Event loop state - epoll_fd stays -1 if the event loop could not be created */
+static int epoll_fd = -1;
+static int timer_fd = -1;
+static int wakeup_fd = -1;
+static watched_fd_t watched_fds[MAX_WATCHED_FDS];
+static int watched_fd_count = 0;
+static driver_backends_wakeup_cb_t wakeup_callback = NULL;
+
 /**********************
  *  GLOBAL VARIABLES
  **********************/
@@ -136,6 +165,8 @@ void driver_backends_register(void)
         backends[i] = b;
         i++;
     }
+
+    event_loop_init();
 }
 
 int driver_backends_init_backend(char *backend_name)
@@ -185,6 +216,9 @@ int driver_backends_init_backend(char *backend_name)
                     return -1;
                 }
 
+                /* Refresh at full rate only while the user interacts */
+                refresh_governor_init(dispb->display);
+
                 sel_display_backend = b;
                 LV_LOG_INFO("Initialized %s display backend", b->name);
                 break;
@@ -278,7 +312,218 @@ void driver_backends_run_loop(void)
     }
 }
 
+void driver_backends_wakeup(void)
+{
+    uint64_t value = 1;
+    ssize_t result;
+
+    if (wakeup_fd >= 0) {
+        /* Can only fail if the counter is saturated - the loop is then woken up anyway */
+        result = write(wakeup_fd, &value, sizeof(value));
+        (void)result;
+    }
+}
+
+void driver_backends_set_wakeup_cb(driver_backends_wakeup_cb_t wakeup_cb)
+{
+    wakeup_callback = wakeup_cb;
+}
+
+int driver_backends_watch_fd(int fd, fd_ready_cb_t ready_cb, void *user_data)
+{
+    struct epoll_event event;
+    watched_fd_t *watched;
+
+    if (epoll_fd < 0) {
+        return -1;
+    }
+
+    /* Reuse the slot of an fd that is no longer watched */
+    for (watched = watched_fds; watched < watched_fds + watched_fd_count; watched++) {
+        if (watched->fd < 0) {
+            break;
+        }
+    }
+    if (watched == watched_fds + MAX_WATCHED_FDS) {
+        return -1;
+    }
+
+    watched->fd = fd;
+    watched->ready_cb = ready_cb;
+    watched->user_data = user_data;
+
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.ptr = watched;
+
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+        LV_LOG_ERROR("Failed to watch fd %d: %s", fd, strerror(errno));
+        watched->fd = -1;
+        return -1;
+    }
+
+    if (watched == watched_fds + watched_fd_count) {
+        watched_fd_count++;
+    }
+    return 0;
+}
+
+void driver_backends_unwatch_fd(int fd)
+{
+    int i;
+
+    for (i = 0; i < watched_fd_count; i++) {
+        if (watched_fds[i].fd == fd) {
+            epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+            watched_fds[i].fd = -1;
+            watched_fds[i].ready_cb = NULL;
+            watched_fds[i].user_data = NULL;
+            return;
+        }
+    }
+}
+
+void driver_backends_event_loop(void)
+{
+    struct epoll_event events[MAX_WATCHED_FDS];
+    watched_fd_t *watched;
+    uint32_t idle_time;
+    int count;
+    int i;
+
+    if (epoll_fd < 0) {
+        sleep_loop();
+        return;
+    }
+
+    /* Handle LVGL tasks */
+    while (true) {
+
+        /* Returns the time to the next timer execution */
+        idle_time = lv_timer_handler();
+        arm_timer_fd(idle_time);
+
+        /* Sleep until a timer is due, an input device has data or another thread wakes us up */
+        count = epoll_wait(epoll_fd, events, MAX_WATCHED_FDS, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LV_LOG_ERROR("epoll_wait failed: %s - falling back to polling", strerror(errno));
+            sleep_loop();
+            return;
+        }
+
+        for (i = 0; i < count; i++) {
+            watched = events[i].data.ptr;
+
+            /* Unwatched by an earlier callback of this round */
+            if (watched->fd < 0) {
+                continue;
+            }
+
+            watched->ready_cb(watched->fd, watched->user_data);
+
+            /* epoll keeps reporting a failed fd, stop watching it rather than spin */
+            if ((events[i].events & (EPOLLERR | EPOLLHUP)) && watched->fd >= 0) {
+                LV_LOG_WARN("Watched fd %d failed - no longer watched", watched->fd);
+                driver_backends_unwatch_fd(watched->fd);
+            }
+        }
+    }
+}
+
 /**********************
  *   STATIC FUNCTIONS
  **********************/
 
+/**
+ * Create the epoll instance, the timerfd and the eventfd of the event loop
+ * @description on failure the event loop falls back to sleeping between timer runs
+ */
+static void event_loop_init(void)
+{
+    if (epoll_fd >= 0) {
+        return;
+    }
+
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if (epoll_fd < 0 || timer_fd < 0 || wakeup_fd < 0) {
+        LV_LOG_ERROR("Failed to create the event loop: %s", strerror(errno));
+    } else if (driver_backends_watch_fd(timer_fd, drain_fd, NULL) == 0 &&
+               driver_backends_watch_fd(wakeup_fd, wakeup_ready_cb, NULL) == 0) {
+        return;
+    }
+
+    if (epoll_fd >= 0) close(epoll_fd);
+    if (timer_fd >= 0) close(timer_fd);
+    if (wakeup_fd >= 0) close(wakeup_fd);
+    epoll_fd = -1;
+    timer_fd = -1;
+    wakeup_fd = -1;
+    watched_fd_count = 0;
+}
+
+/**
+ * Run LVGL by sleeping between timer runs
+ */
+static void sleep_loop(void)
+{
+    uint32_t idle_time;
+
+    /* Handle LVGL tasks */
+    while (true) {
+
+        /* Returns the time to the next timer execution */
+        idle_time = lv_timer_handler();
+        usleep(idle_time * 1000);
+    }
+}
+
+/**
+ * Arm the timerfd to expire when the next LVGL timer is due
+ * @param idle_time the time returned by lv_timer_handler in ms
+ */
+static void arm_timer_fd(uint32_t idle_time)
+{
+    struct itimerspec spec;
+
+    /* An all-zero value disarms the timer - used when no LVGL timer is running */
+    memset(&spec, 0, sizeof(spec));
+    if (idle_time != LV_NO_TIMER_READY) {
+        spec.it_value.tv_sec = idle_time / 1000;
+        /* Add a nanosecond so that a due timer still expires right away */
+        spec.it_value.tv_nsec = (long)(idle_time % 1000) * 1000000 + 1;
+    }
+
+    timerfd_settime(timer_fd, 0, &spec, NULL);
+}
+
+/**
+ * Consume the counter of a timerfd or eventfd
+ */
+static void drain_fd(int fd, void *user_data)
+{
+    uint64_t value;
+    ssize_t result;
+
+    (void)user_data;
+    result = read(fd, &value, sizeof(value));
+    (void)result;
+}
+
+/**
+ * Run the wakeup callback after another thread called driver_backends_wakeup()
+ */
+static void wakeup_ready_cb(int fd, void *user_data)
+{
+    drain_fd(fd, user_data);
+
+    if (wakeup_callback != NULL) {
+        wakeup_callback();
+    }
+}
+
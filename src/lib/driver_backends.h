@@ -35,6 +35,9 @@ extern "C" {
  *      TYPEDEFS
  **********************/
 
+/* Prototype of the function run on the LVGL thread after driver_backends_wakeup() */
+typedef void (*driver_backends_wakeup_cb_t)(void);
+
 /**********************
  * GLOBAL PROTOTYPES
  **********************/
@@ -78,6 +81,19 @@ int driver_backends_print_supported(void);
  */
 void driver_backends_run_loop(void);
 
+/**
+ * @brief Wake up the run loop
+ * @description safe to call from any thread, the wakeup callback then runs
+ * on the LVGL thread. Has no effect with backends that do not use the shared event loop
+ */
+void driver_backends_wakeup(void);
+
+/**
+ * @brief Set the function run on the LVGL thread after driver_backends_wakeup()
+ * @param wakeup_cb the callback, NULL to only run the LVGL timers
+ */
+void driver_backends_set_wakeup_cb(driver_backends_wakeup_cb_t wakeup_cb);
+
 /**********************
  *      MACROS
  **********************/
@@ -17,9 +17,12 @@
 /*********************
  *      INCLUDES
  *********************/
+#include <errno.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <linux/input.h>
 
 #include "lvgl/lvgl.h"
 #if LV_USE_EVDEV
@@ -30,6 +33,9 @@
  *      DEFINES
  *********************/
 
+/* Period of the check that stops polling an input device once it is no longer in use */
+#define EVDEV_IDLE_CHECK_PERIOD_MS 200
+
 /**********************
  *      TYPEDEFS
  **********************/
@@ -42,6 +48,9 @@ static void indev_deleted_cb(lv_event_t *e);
 static void discovery_cb(lv_indev_t *indev, lv_evdev_type_t type, void *user_data);
 static void set_mouse_cursor_icon(lv_indev_t *indev, lv_display_t *display);
 static lv_indev_t *init_pointer_evdev(lv_display_t *display);
+static void watch_evdev(lv_indev_t *indev, const char *input_device);
+static void evdev_ready_cb(int fd, void *user_data);
+static void evdev_idle_timer_cb(lv_timer_t *timer);
 
 /**********************
  *  STATIC VARIABLES
@@ -49,6 +58,9 @@ static lv_indev_t *init_pointer_evdev(lv_display_t *display);
 
 static char *backend_name = "EVDEV";
 
+/* Pauses the read timer of the watched input device when it becomes idle */
+static lv_timer_t *idle_timer = NULL;
+
 /**********************
  *      MACROS
  **********************/
@@ -171,6 +183,90 @@ static lv_indev_t *init_pointer_evdev(lv_display_t *display)
     lv_indev_set_display(indev, display);
 
     set_mouse_cursor_icon(indev, display);
+    watch_evdev(indev, input_device);
     return indev;
 }
+
+/*
+ * Read the input device only while it is in use
+ *
+ * @description The device is watched by the event loop on a second fd, the read
+ * timer of the indev is paused while the device is idle and resumed as soon as
+ * it has data. Keeps polling if the event loop is unavailable.
+ * @param indev the input device
+ * @param input_device the path of the device
+ */
+static void watch_evdev(lv_indev_t *indev, const char *input_device)
+{
+    int fd = open(input_device, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+
+    if (fd < 0) {
+        return;
+    }
+
+    if (driver_backends_watch_fd(fd, evdev_ready_cb, indev) != 0) {
+        close(fd);
+        return;
+    }
+
+    idle_timer = lv_timer_create(evdev_idle_timer_cb, EVDEV_IDLE_CHECK_PERIOD_MS, indev);
+    lv_timer_pause(lv_indev_get_read_timer(indev));
+    lv_timer_pause(idle_timer);
+}
+
+/*
+ * Resume reading the input device
+ *
+ * @description If the device failed, e.g. it was unplugged, the second fd is
+ * closed and the indev goes back to polling with its read timer
+ * @note called by the event loop when the watched fd is readable or failed
+ * @param fd the watched fd
+ * @param user_data the input device
+ */
+static void evdev_ready_cb(int fd, void *user_data)
+{
+    lv_indev_t *indev = user_data;
+    lv_timer_t *read_timer = lv_indev_get_read_timer(indev);
+    struct input_event events[16];
+    ssize_t result;
+
+    /* Only the readiness matters - the driver reads the events from its own fd */
+    do {
+        result = read(fd, events, sizeof(events));
+    } while (result > 0);
+
+    if (result == 0 || (errno != EAGAIN && errno != EINTR)) {
+        LV_LOG_WARN("Input device failed - polling it instead");
+        driver_backends_unwatch_fd(fd);
+        close(fd);
+        lv_timer_delete(idle_timer);
+        idle_timer = NULL;
+        lv_timer_resume(read_timer);
+        return;
+    }
+
+    lv_timer_resume(read_timer);
+    lv_timer_ready(read_timer);
+    lv_timer_resume(idle_timer);
+}
+
+/*
+ * Stop reading the input device once it is idle
+ *
+ * @description The device keeps being read while it is pressed, for long presses,
+ * and while a scroll is still moving after the release
+ * @param timer the idle check timer
+ */
+static void evdev_idle_timer_cb(lv_timer_t *timer)
+{
+    lv_indev_t *indev = lv_timer_get_user_data(timer);
+
+    if (lv_indev_get_state(indev) == LV_INDEV_STATE_PRESSED ||
+        lv_indev_get_scroll_obj(indev) != NULL) {
+        return;
+    }
+
+    lv_timer_pause(lv_indev_get_read_timer(indev));
+    lv_timer_pause(timer);
+}
 #endif /*#if LV_USE_EVDEV*/
@@ -0,0 +1,117 @@
+/**
+ * @file refresh_governor.c
+ *
+ * Adapts the refresh rate of a display to what is happening on it
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "refresh_governor.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+
+static bool is_interacting(lv_display_t *display);
+static void set_refresh_period(lv_display_t *display);
+static void invalidate_area_cb(lv_event_t *e);
+static void refr_ready_cb(lv_event_t *e);
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void refresh_governor_init(lv_display_t *display)
+{
+    if (display == NULL) {
+        return;
+    }
+
+    lv_display_add_event_cb(display, invalidate_area_cb, LV_EVENT_INVALIDATE_AREA, display);
+    lv_display_add_event_cb(display, refr_ready_cb, LV_EVENT_REFR_READY, display);
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/**
+ * Check if the user is interacting with the display
+ *
+ * @description an input device is pressed, a scroll is still moving or
+ * the last input is recent enough for a follow-up to be expected
+ * @param display the display
+ * @return true while the user interacts
+ */
+static bool is_interacting(lv_display_t *display)
+{
+    lv_indev_t *indev;
+
+    if (lv_display_get_inactive_time(display) < REFRESH_GOVERNOR_INTERACTION_HOLD) {
+        return true;
+    }
+
+    for (indev = lv_indev_get_next(NULL); indev != NULL; indev = lv_indev_get_next(indev)) {
+        if (lv_indev_get_state(indev) == LV_INDEV_STATE_PRESSED ||
+            lv_indev_get_scroll_obj(indev) != NULL) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Set the period of the refresh timer for the current activity
+ *
+ * @param display the display
+ */
+static void set_refresh_period(lv_display_t *display)
+{
+    lv_timer_t *refr_timer = lv_display_get_refr_timer(display);
+    uint32_t period;
+
+    if (refr_timer == NULL) {
+        return;
+    }
+
+    period = is_interacting(display) ? LV_DEF_REFR_PERIOD : REFRESH_GOVERNOR_IDLE_PERIOD;
+    lv_timer_set_period(refr_timer, period);
+}
+
+/**
+ * Restore the full refresh rate as soon as an input invalidates the screen
+ *
+ * @description an invalidation after a long pause is refreshed right away
+ * in any case, as the paused timer is overdue when it resumes
+ * @param e the invalidation event
+ */
+static void invalidate_area_cb(lv_event_t *e)
+{
+    set_refresh_period(lv_event_get_user_data(e));
+}
+
+/**
+ * Choose the cadence of the next refresh
+ *
+ * @description LVGL pauses the refresh timer by itself when nothing is
+ * invalid, the governor only chooses how fast pending changes are drawn
+ * @param e the refresh ready event
+ */
+static void refr_ready_cb(lv_event_t *e)
+{
+    set_refresh_period(lv_event_get_user_data(e));
+}
@@ -0,0 +1,50 @@
+/**
+ * @file refresh_governor.h
+ *
+ * Adapts the refresh rate of a display to what is happening on it
+ *
+ * - full rate (LV_DEF_REFR_PERIOD) while the user interacts with the screen
+ * - a slow cadence for changes nobody is interacting with, e.g. the
+ *   animations of a signage screen updating itself
+ * - no refresh at all while nothing is invalid, LVGL keeps the refresh
+ *   timer paused until the next invalidation
+ *
+ */
+
+#ifndef REFRESH_GOVERNOR_H
+#define REFRESH_GOVERNOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lvgl/lvgl.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/* Refresh period used when nobody is interacting with the screen [ms] */
+#define REFRESH_GOVERNOR_IDLE_PERIOD 100
+
+/* Time after the last input during which the full refresh rate is kept [ms] */
+#define REFRESH_GOVERNOR_INTERACTION_HOLD 2000
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * @brief Govern the refresh rate of a display
+ * @param display the display to govern
+ */
+void refresh_governor_init(lv_display_t *display);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*REFRESH_GOVERNOR_H*/
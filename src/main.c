@@ -13,6 +13,8 @@
 #include "schedule_ui.h"
 #include "time_date_display.h"
 #include "schedule_data.h"
+#include "schedule_cache.h"
+#include "ui_scheduler.h"
 #include "config.h"
 #include <time.h>
 
@@ -110,21 +112,6 @@ static void configure_simulator(int argc, char **argv)
     }
 }
 
-static lv_timer_t* minute_timer;
-
-static void minute_tick(lv_timer_t* timer)
-{
-    (void)timer;
-
-    time_t now = time(NULL);
-    struct tm* t = localtime(&now);
-    if (t->tm_sec == 0) // Trigger only when seconds are 0
-    {
-        update_time_and_date_display();
-        update_progress_bar();
-    }
-}
-
 /**
  * @brief entry point
  * @description start a demo
@@ -149,13 +136,29 @@ int main(int argc, char **argv)
         return -1;
     }
 
+    // Apply completed fetches as soon as the fetch thread wakes up the run loop
+    set_schedule_fetch_notify(driver_backends_wakeup);
+    driver_backends_set_wakeup_cb(handle_schedule_fetch_results);
+
+    // Start background fetching of schedule data
+    if (init_schedule_data() != 0)
+    {
+        die("Failed to initialize schedule data");
+    }
+
     // Set configuration values
     set_room_id(config.roomId);
     set_dark_theme(config.isDarkTheme);
     set_inactive_duration(config.inactiveDurationMs);
+    set_day_switch_fade(config.daySwitchFadeMs);
+    set_prefetch_days(config.prefetchDays);
+    set_schedule_max_age(config.cacheMaxAgeMinutes * 60);
+    schedule_cache_set_limits(config.cacheTtlMinutes * 60, (size_t)config.cacheMemoryLimitKb * 1024);
+    set_schedule_cache_file(config.cacheFile);
 
-    // Free allocated memory for roomId
+    // Free allocated memory for roomId and cacheFile
     free(config.roomId);
+    free(config.cacheFile);
     
     /* Initialize the configured backend */
     if (driver_backends_init_backend(selected_backend) == -1)
@@ -185,8 +188,8 @@ int main(int argc, char **argv)
     init_time_and_date_display();
     init_schedule_ui();
 
-    // Create minute timer (check every second for minute change)
-    minute_timer = lv_timer_create(minute_tick, 1000, NULL);
+    // Arm the time-driven updates (clock, lesson progress, return to today)
+    ui_scheduler_init();
 
     /* Enter the run loop of the selected backend */
     driver_backends_run_loop();
@@ -0,0 +1,242 @@
+﻿#include "schedule_cache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Number of days the cache can hold
+#define SCHEDULE_CACHE_CAPACITY 64
+
+static schedule_cache_entry_t entries[SCHEDULE_CACHE_CAPACITY];
+static uint64_t use_clock = 0;
+static uint32_t generation_clock = 0;
+static uint32_t ttl_seconds = 6 * 60 * 60;
+static schedule_cache_stats_t stats = { .memory_limit = 512 * 1024 };
+
+static bool entry_matches(const schedule_cache_entry_t* entry, const char* room_id, const struct tm* date)
+{
+    return entry->in_use &&
+           entry->date.tm_year == date->tm_year &&
+           entry->date.tm_mon == date->tm_mon &&
+           entry->date.tm_mday == date->tm_mday &&
+           strcmp(entry->room_id, room_id) == 0;
+}
+
+// Entries waiting for a fetch are kept until its result is applied
+static bool is_evictable(const schedule_cache_entry_t* entry)
+{
+    return entry->in_use && !entry->pinned && entry->state != SCHEDULE_STATE_PENDING && !entry->is_revalidating;
+}
+
+static bool is_expired(const schedule_cache_entry_t* entry, time_t now)
+{
+    return entry->state == SCHEDULE_STATE_READY && !entry->is_stale && !entry->is_revalidating &&
+           now - entry->updated_at >= (time_t)ttl_seconds;
+}
+
+static size_t validators_memory_size(const schedule_cache_entry_t* entry)
+{
+    return (entry->etag ? strlen(entry->etag) + 1 : 0) +
+           (entry->last_modified ? strlen(entry->last_modified) + 1 : 0);
+}
+
+// Least recently used entry that may be evicted, other than the one being kept
+static schedule_cache_entry_t* find_lru_entry(const schedule_cache_entry_t* keep)
+{
+    schedule_cache_entry_t* victim = NULL;
+    for (int i = 0; i < SCHEDULE_CACHE_CAPACITY; i++)
+    {
+        schedule_cache_entry_t* entry = &entries[i];
+        if (entry == keep || !is_evictable(entry)) continue;
+        if (!victim || entry->last_used < victim->last_used)
+        {
+            victim = entry;
+        }
+    }
+    return victim;
+}
+
+void schedule_cache_set_limits(uint32_t ttl_s, size_t memory_limit)
+{
+    ttl_seconds = ttl_s;
+    stats.memory_limit = memory_limit;
+}
+
+schedule_cache_entry_t* schedule_cache_find(const char* room_id, const struct tm* date)
+{
+    if (!room_id || !date) return NULL;
+
+    for (int i = 0; i < SCHEDULE_CACHE_CAPACITY; i++)
+    {
+        if (entry_matches(&entries[i], room_id, date))
+        {
+            return &entries[i];
+        }
+    }
+    return NULL;
+}
+
+schedule_cache_entry_t* schedule_cache_lookup(const char* room_id, const struct tm* date)
+{
+    schedule_cache_entry_t* entry = schedule_cache_find(room_id, date);
+
+    // An expired day is still served, its validators let it be fetched again with a conditional request
+    if (entry && is_expired(entry, time(NULL)))
+    {
+        entry->is_stale = true;
+        stats.expirations++;
+    }
+
+    if (!entry)
+    {
+        stats.misses++;
+        return NULL;
+    }
+
+    stats.hits++;
+    entry->last_used = ++use_clock;
+    return entry;
+}
+
+schedule_cache_entry_t* schedule_cache_insert(const char* room_id, const struct tm* date)
+{
+    if (!room_id || !date) return NULL;
+
+    schedule_cache_entry_t* entry = NULL;
+    for (int i = 0; i < SCHEDULE_CACHE_CAPACITY; i++)
+    {
+        if (!entries[i].in_use)
+        {
+            entry = &entries[i];
+            break;
+        }
+    }
+
+    if (!entry)
+    {
+        entry = find_lru_entry(NULL);
+        if (!entry) return NULL;
+        schedule_cache_remove(entry);
+        stats.evictions++;
+    }
+
+    entry->room_id = strdup(room_id);
+    if (!entry->room_id)
+    {
+        fprintf(stderr, "Failed to allocate memory for cache entry\n");
+        return NULL;
+    }
+    entry->date = *date;
+    entry->state = SCHEDULE_STATE_PENDING;
+    entry->updated_at = time(NULL);
+    entry->last_used = ++use_clock;
+    if (++generation_clock == 0) generation_clock++; // 0 is never a generation
+    entry->generation = generation_clock;
+    entry->in_use = true;
+    stats.entry_count++;
+    return entry;
+}
+
+void schedule_cache_store(schedule_cache_entry_t* entry, lesson_day_t* lessons, schedule_state_t state)
+{
+    if (!entry || !entry->in_use)
+    {
+        lesson_day_release(lessons);
+        return;
+    }
+
+    // Publish the new snapshot in a single exchange; readers that retained the old one keep it alive
+    lesson_day_t* old_lessons = __atomic_exchange_n(&entry->lessons, lessons, __ATOMIC_ACQ_REL);
+    lesson_day_release(old_lessons);
+    stats.memory_used -= entry->memory_size;
+
+    // The strings of the lessons are pooled and shared between days, only the day block is counted
+    entry->memory_size = lesson_day_memory_size(lessons) + validators_memory_size(entry);
+    entry->state = state;
+    entry->updated_at = time(NULL);
+    entry->is_stale = false;
+    entry->is_revalidating = false;
+    stats.memory_used += entry->memory_size;
+
+    // Respect the memory limit, never evicting the day just stored
+    while (stats.memory_used > stats.memory_limit)
+    {
+        schedule_cache_entry_t* victim = find_lru_entry(entry);
+        if (!victim) break;
+        schedule_cache_remove(victim);
+        stats.evictions++;
+    }
+}
+
+bool schedule_cache_revalidate(schedule_cache_entry_t* entry, lesson_day_t* lessons)
+{
+    if (entry && entry->in_use && entry->state == SCHEDULE_STATE_READY &&
+        lesson_day_equal(entry->lessons, lessons))
+    {
+        // Same schedule, keep the current lessons so that nothing has to be redrawn
+        lesson_day_release(lessons);
+        schedule_cache_touch(entry);
+        return false;
+    }
+
+    schedule_cache_store(entry, lessons, SCHEDULE_STATE_READY);
+    return true;
+}
+
+void schedule_cache_touch(schedule_cache_entry_t* entry)
+{
+    if (!entry || !entry->in_use) return;
+
+    entry->updated_at = time(NULL);
+    entry->is_stale = false;
+    entry->is_revalidating = false;
+}
+
+void schedule_cache_set_validators(schedule_cache_entry_t* entry, char* etag, char* last_modified)
+{
+    if (!entry || !entry->in_use)
+    {
+        free(etag);
+        free(last_modified);
+        return;
+    }
+
+    size_t old_size = validators_memory_size(entry);
+    free(entry->etag);
+    free(entry->last_modified);
+    entry->etag = etag;
+    entry->last_modified = last_modified;
+
+    size_t new_size = validators_memory_size(entry);
+    entry->memory_size = entry->memory_size - old_size + new_size;
+    stats.memory_used = stats.memory_used - old_size + new_size;
+}
+
+void schedule_cache_remove(schedule_cache_entry_t* entry)
+{
+    if (!entry || !entry->in_use) return;
+
+    lesson_day_release(entry->lessons);
+    free(entry->room_id);
+    free(entry->etag);
+    free(entry->last_modified);
+    stats.memory_used -= entry->memory_size;
+    stats.entry_count--;
+    memset(entry, 0, sizeof(*entry));
+}
+
+void schedule_cache_foreach(void (*callback)(schedule_cache_entry_t* entry, void* user_data), void* user_data)
+{
+    for (int i = 0; i < SCHEDULE_CACHE_CAPACITY; i++)
+    {
+        if (entries[i].in_use)
+        {
+            callback(&entries[i], user_data);
+        }
+    }
+}
+
+void schedule_cache_get_stats(schedule_cache_stats_t* out_stats)
+{
+    if (!out_stats) return;
+    *out_stats = stats;
+}
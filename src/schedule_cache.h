@@ -0,0 +1,129 @@
+﻿#ifndef SCHEDULE_CACHE_H
+#define SCHEDULE_CACHE_H
+
+#include "schedule_data.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+/**
+ * A day of schedule kept in the cache, keyed by room ID and date.
+ */
+typedef struct {
+    char* room_id;          /* Room of the schedule */
+    struct tm date;         /* Date of the schedule */
+    lesson_day_t* lessons;  /* Published snapshot of the lessons, NULL until fetched */
+    char* etag;             /* Validators of the last fetched response, NULL if unknown */
+    char* last_modified;
+    schedule_state_t state; /* Availability of the schedule */
+    time_t updated_at;      /* Time the state last changed */
+    time_t attempted_at;    /* Time the last fetch was started, 0 if never */
+    uint64_t last_used;     /* LRU stamp, higher is more recent */
+    size_t memory_size;     /* Bytes held by the lessons and the validators */
+    uint32_t generation;    /* Distinguishes the entry from earlier ones of the same day, never 0 */
+    bool is_stale;          /* Served as is, but must be fetched again */
+    bool is_revalidating;   /* A fetch replacing the lessons is in progress */
+    bool pinned;            /* Pinned entries are never evicted */
+    bool in_use;            /* Whether the slot holds a day */
+} schedule_cache_entry_t;
+
+/**
+ * Cache counters.
+ */
+typedef struct {
+    uint32_t hits;          /* Lookups answered from the cache */
+    uint32_t misses;        /* Lookups of absent days */
+    uint32_t evictions;     /* Days dropped to make room or to respect the memory limit */
+    uint32_t expirations;   /* Days marked stale because their TTL elapsed */
+    int entry_count;        /* Days currently cached */
+    size_t memory_used;     /* Bytes held by cached lessons */
+    size_t memory_limit;    /* Maximum bytes held by cached lessons */
+} schedule_cache_stats_t;
+
+/**
+ * Sets the cache limits.
+ * @param ttl_s         Seconds after which a fetched day is marked stale and fetched again.
+ * @param memory_limit  Maximum bytes held by cached lessons; least recently used days are evicted beyond it.
+ */
+void schedule_cache_set_limits(uint32_t ttl_s, size_t memory_limit);
+
+/**
+ * Looks up a day, counting a hit or a miss and refreshing its LRU position.
+ * Expired days are still returned, marked stale so that they are fetched again.
+ * @param room_id Pointer to a string containing the room ID.
+ * @param date    Pointer to a struct tm containing the date (year, month, day).
+ * @return The cached entry, or NULL on a miss.
+ */
+schedule_cache_entry_t* schedule_cache_lookup(const char* room_id, const struct tm* date);
+
+/**
+ * Finds a day without touching counters, LRU order or expiry.
+ * @param room_id Pointer to a string containing the room ID.
+ * @param date    Pointer to a struct tm containing the date (year, month, day).
+ * @return The cached entry, or NULL if the day is not cached.
+ */
+schedule_cache_entry_t* schedule_cache_find(const char* room_id, const struct tm* date);
+
+/**
+ * Adds an empty pending entry for a day, evicting the least recently used day if the cache is full.
+ * @param room_id Pointer to a string containing the room ID.
+ * @param date    Pointer to a struct tm containing the date (year, month, day).
+ * @return The new entry, or NULL if every entry is pending or pinned.
+ */
+schedule_cache_entry_t* schedule_cache_insert(const char* room_id, const struct tm* date);
+
+/**
+ * Stores fetched lessons in an entry, taking over their reference, and enforces the memory limit.
+ * The previous lessons are released; readers that retained them keep a valid snapshot.
+ * @param entry         Pointer to the entry to update.
+ * @param lessons       Lessons allocated by the fetch layer, may be NULL.
+ * @param state         New state of the entry.
+ */
+void schedule_cache_store(schedule_cache_entry_t* entry, lesson_day_t* lessons, schedule_state_t state);
+
+/**
+ * Applies the result of a background revalidation of a day that is already available.
+ * The lessons are swapped in only if they differ from the cached ones; otherwise they are
+ * freed and the entry is only marked fresh again.
+ * @param entry         Pointer to the entry to update.
+ * @param lessons       Lessons allocated by the fetch layer, may be NULL.
+ * @return true if the lessons of the entry changed.
+ */
+bool schedule_cache_revalidate(schedule_cache_entry_t* entry, lesson_day_t* lessons);
+
+/**
+ * Marks an available entry fresh again without touching its lessons,
+ * e.g. after the server confirmed that the schedule has not changed.
+ * @param entry Pointer to the entry to update.
+ */
+void schedule_cache_touch(schedule_cache_entry_t* entry);
+
+/**
+ * Replaces the validators sent with conditional requests for an entry, taking ownership of them.
+ * @param entry         Pointer to the entry to update.
+ * @param etag          ETag of the last fetched response, may be NULL.
+ * @param last_modified Last-Modified date of the last fetched response, may be NULL.
+ */
+void schedule_cache_set_validators(schedule_cache_entry_t* entry, char* etag, char* last_modified);
+
+/**
+ * Drops an entry and frees its lessons.
+ * @param entry Pointer to the entry to drop.
+ */
+void schedule_cache_remove(schedule_cache_entry_t* entry);
+
+/**
+ * Calls a function for every cached day.
+ * @param callback  Function called with each entry.
+ * @param user_data Pointer passed to the callback.
+ */
+void schedule_cache_foreach(void (*callback)(schedule_cache_entry_t* entry, void* user_data), void* user_data);
+
+/**
+ * Reads the cache counters.
+ * @param stats Pointer to a schedule_cache_stats_t that receives the counters.
+ */
+void schedule_cache_get_stats(schedule_cache_stats_t* stats);
+
+#endif
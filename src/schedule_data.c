@@ -1,13 +1,168 @@
 ﻿#include "schedule_data.h"
 #include "api.h"
+#include "fetch_worker.h"
+#include "schedule_cache.h"
+#include "schedule_store.h"
+#include "string_pool.h"
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 
-static lesson_t* lessons = NULL;
-static int lesson_count = 0;
-static struct tm last_fetched_date = { 0 };
+// Seconds before a failed fetch may be retried
+#define FETCH_RETRY_DELAY_S 60
+// Prefetch horizon limit, keeps a prefetch round within the fetch queue
+#define MAX_PREFETCH_DAYS 14
+
+static schedule_cache_entry_t* current_day = NULL; // Displayed day, pinned in the cache
 static char* current_room_id = NULL;
+static int prefetch_days = 7;
+static uint32_t max_age_seconds = 10 * 60; // Age after which available days are fetched again
+static int pending_fetches = 0;
+static char* cache_file_path = NULL; // File the cache is persisted to, NULL to disable
+static bool is_cache_file_dirty = false;
+static bool is_current_day_updated = false; // Lessons of current_day were replaced
+
+static void set_current_day(schedule_cache_entry_t* day)
+{
+    if (current_day == day) return;
+
+    if (current_day)
+    {
+        current_day->pinned = false;
+    }
+    current_day = day;
+    is_current_day_updated = false;
+    if (current_day)
+    {
+        current_day->pinned = true;
+    }
+}
+
+// Whether an available day is older than the max-age or was loaded from the cache file
+static bool is_stale(const schedule_cache_entry_t* day)
+{
+    return day->is_stale || time(NULL) - day->updated_at >= (time_t)max_age_seconds;
+}
+
+// Whether a cached day has to be fetched again
+static bool needs_fetch(const schedule_cache_entry_t* day)
+{
+    if (day->state == SCHEDULE_STATE_PENDING || day->is_revalidating) return false;
+    if (day->state == SCHEDULE_STATE_READY && !is_stale(day)) return false;
+
+    // Failed and stale days are retried, but not more often than FETCH_RETRY_DELAY_S
+    return day->attempted_at == 0 || time(NULL) - day->attempted_at >= FETCH_RETRY_DELAY_S;
+}
+
+// Starts a background fetch for the date unless it is cached, in progress or recently failed.
+// Stale days keep being served while they are fetched again.
+static schedule_cache_entry_t* request_day(const struct tm* date, bool urgent)
+{
+    // Only lookups for display count towards the cache statistics
+    schedule_cache_entry_t* day = urgent ? schedule_cache_lookup(current_room_id, date) :
+                                           schedule_cache_find(current_room_id, date);
+    if (day && !needs_fetch(day))
+    {
+        return day;
+    }
+
+    if (!day)
+    {
+        day = schedule_cache_insert(current_room_id, date);
+        if (!day) return NULL;
+    }
+
+    // Revalidation is conditional, an unchanged schedule then costs only a 304 response
+    bool is_available = day->state == SCHEDULE_STATE_READY;
+    if (fetch_worker_submit(current_room_id, date, is_available ? day->etag : NULL,
+            is_available ? day->last_modified : NULL, urgent, day->generation) != 0)
+    {
+        if (day->state == SCHEDULE_STATE_PENDING)
+        {
+            schedule_cache_remove(day);
+            return NULL;
+        }
+        // Keep the failed or stale day, it is retried later
+        return day;
+    }
+
+    if (is_available)
+    {
+        day->is_revalidating = true;
+    }
+    else
+    {
+        day->state = SCHEDULE_STATE_PENDING;
+        day->updated_at = time(NULL);
+    }
+    day->attempted_at = time(NULL);
+    pending_fetches++;
+    return day;
+}
+
+static bool strings_differ(const char* a, const char* b)
+{
+    return (a == NULL) != (b == NULL) || (a && strcmp(a, b) != 0);
+}
+
+// Moves the validators of a fetch result to the day if they changed
+static bool update_validators(schedule_cache_entry_t* day, fetch_result_t* result)
+{
+    if (!result->etag && !result->last_modified) return false;
+    if (!strings_differ(day->etag, result->etag) && !strings_differ(day->last_modified, result->last_modified))
+    {
+        return false;
+    }
+
+    schedule_cache_set_validators(day, result->etag, result->last_modified);
+    result->etag = NULL;
+    result->last_modified = NULL;
+    return true;
+}
+
+// Reports the cache counters, once per completed round of fetches
+static void log_schedule_stats(void)
+{
+    schedule_cache_stats_t cache_stats;
+    schedule_cache_get_stats(&cache_stats);
+    printf("Schedule cache: %d days, %zu of %zu bytes, %u hits, %u misses, %u evictions, %u expirations\n",
+        cache_stats.entry_count, cache_stats.memory_used, cache_stats.memory_limit, (unsigned)cache_stats.hits,
+        (unsigned)cache_stats.misses, (unsigned)cache_stats.evictions, (unsigned)cache_stats.expirations);
+
+    api_transfer_stats_t transfer_stats;
+    api_get_transfer_stats(&transfer_stats);
+    printf("Schedule transfers: %u fetches, %u not modified, %llu bytes received, %llu bytes decoded\n",
+        (unsigned)transfer_stats.fetches, (unsigned)transfer_stats.not_modified,
+        (unsigned long long)transfer_stats.wire_bytes, (unsigned long long)transfer_stats.decoded_bytes);
+
+    string_pool_stats_t pool_stats;
+    string_pool_get_stats(&pool_stats);
+    printf("String pool: %u strings for %llu references, %zu of %zu bytes stored\n",
+        (unsigned)pool_stats.unique_strings, (unsigned long long)pool_stats.references,
+        pool_stats.bytes_stored, pool_stats.bytes_requested);
+}
+
+int init_schedule_data(void)
+{
+    if (api_init() != 0)
+    {
+        return -1;
+    }
+
+    if (fetch_worker_start() != 0)
+    {
+        api_cleanup();
+        return -1;
+    }
+
+    return 0;
+}
+
+void set_schedule_fetch_notify(void (*notify)(void))
+{
+    fetch_worker_set_notify(notify);
+}
 
 void set_room_id(const char* room_id)
 {
@@ -17,54 +172,175 @@ void set_room_id(const char* room_id)
     }
 
     current_room_id = strdup(room_id);
+
+    // Days of the previous room stay cached under their own key
+    set_current_day(NULL);
+}
+
+void set_schedule_cache_file(const char* path)
+{
+    free(cache_file_path);
+    cache_file_path = path ? strdup(path) : NULL;
+    if (!cache_file_path) return;
+
+    int loaded = schedule_store_load(cache_file_path);
+    if (loaded > 0)
+    {
+        printf("Loaded %d days from schedule cache file %s\n", loaded, cache_file_path);
+    }
+}
+
+void set_prefetch_days(int days_around)
+{
+    if (days_around < 0) days_around = 0;
+    if (days_around > MAX_PREFETCH_DAYS) days_around = MAX_PREFETCH_DAYS;
+    prefetch_days = days_around;
 }
 
-int get_lesson_count(void)
+void set_schedule_max_age(uint32_t max_age_s)
 {
-    return lesson_count;
+    max_age_seconds = max_age_s;
 }
 
-lesson_t get_lesson(int index)
+schedule_state_t get_schedule_state_for_date(struct tm* date)
 {
-    if (index >= 0 && index < lesson_count)
+    if (!current_room_id || !date) return SCHEDULE_STATE_FAILED;
+
+    schedule_cache_entry_t* day = schedule_cache_find(current_room_id, date);
+
+    // Not requested yet, get_lessons_for_date() will start the fetch
+    return day ? day->state : SCHEDULE_STATE_PENDING;
+}
+
+const lesson_day_t* get_lessons_for_date(struct tm* date)
+{
+    if (!current_room_id || !date) return NULL;
+
+    schedule_cache_entry_t* day = request_day(date, true);
+    if (!day || day->state != SCHEDULE_STATE_READY)
     {
-        return lessons[index];
+        // Wait for process_schedule_fetch_results()
+        return NULL;
     }
 
-    static lesson_t empty = { 0 };
-    return empty;
+    return __atomic_load_n(&day->lessons, __ATOMIC_ACQUIRE);
+}
+
+void set_displayed_schedule_date(const struct tm* date)
+{
+    set_current_day(current_room_id && date ? schedule_cache_find(current_room_id, date) : NULL);
 }
 
-int get_lesson_count_for_date(struct tm* date)
+void prefetch_schedule(const struct tm* date)
 {
-    if (!current_room_id || !date) return 0;
+    if (!current_room_id || !date) return;
 
-    // Checking if the data needs to be updated
-    if (date->tm_year != last_fetched_date.tm_year ||
-        date->tm_mon != last_fetched_date.tm_mon ||
-        date->tm_mday != last_fetched_date.tm_mday)
+    for (int offset = -prefetch_days; offset <= prefetch_days; offset++)
     {
-        free(lessons);
-        lessons = NULL;
-        lesson_count = 0;
+        struct tm day_date = { 0 };
+        day_date.tm_year = date->tm_year;
+        day_date.tm_mon = date->tm_mon;
+        day_date.tm_mday = date->tm_mday + offset;
+        day_date.tm_hour = 12; // Keeps the date stable across DST changes
+        day_date.tm_isdst = -1;
+        mktime(&day_date);
 
-        if (fetch_schedule_data(current_room_id, date, &lessons, &lesson_count) != 0)
-        {
-            return 0;
-        }
-        last_fetched_date = *date;
+        request_day(&day_date, false);
     }
-    return lesson_count;
 }
 
-lesson_t get_lesson_for_date(struct tm* date, int index)
+void revalidate_schedule(const struct tm* date)
 {
-    int count = get_lesson_count_for_date(date);
-    if (count <= 0 || index < 0 || index >= count)
+    if (!current_room_id || !date) return;
+
+    request_day(date, false);
+}
+
+bool process_schedule_fetch_results(void)
+{
+    bool changed = false;
+    bool has_results = false;
+    fetch_result_t result;
+
+    while (fetch_worker_poll(&result))
     {
-        static lesson_t empty = { 0 };
-        return empty;
+        pending_fetches--;
+        has_results = true;
+
+        // A result issued for a day that was dropped since then must not be applied to its replacement
+        schedule_cache_entry_t* day = schedule_cache_find(result.room_id, &result.date);
+        if (day && day->generation != result.tag)
+        {
+            day = NULL;
+        }
+        if (day && day->is_revalidating && result.status == API_FETCH_NOT_MODIFIED)
+        {
+            // The server confirmed the cached lessons, nothing is parsed or redrawn
+            schedule_cache_touch(day);
+            is_cache_file_dirty |= update_validators(day, &result);
+        }
+        else if (day && day->is_revalidating && result.status != 0)
+        {
+            // Keep serving the stale day, it is retried later
+            day->is_revalidating = false;
+            lesson_day_release(result.lessons);
+        }
+        else if (day && day->is_revalidating)
+        {
+            // Only a schedule that actually changed replaces the one being served
+            is_cache_file_dirty |= update_validators(day, &result);
+            if (schedule_cache_revalidate(day, result.lessons))
+            {
+                is_current_day_updated |= day == current_day;
+                is_cache_file_dirty = true;
+                changed = true;
+            }
+        }
+        else if (day && day->state == SCHEDULE_STATE_PENDING)
+        {
+            bool is_fetched = result.status == 0;
+            if (is_fetched)
+            {
+                update_validators(day, &result);
+            }
+            schedule_cache_store(day, result.lessons,
+                is_fetched ? SCHEDULE_STATE_READY : SCHEDULE_STATE_FAILED);
+            is_cache_file_dirty |= is_fetched;
+            is_current_day_updated |= day == current_day;
+            changed = true;
+        }
+        else
+        {
+            lesson_day_release(result.lessons);
+        }
+
+        free(result.etag);
+        free(result.last_modified);
+        free(result.room_id);
+    }
+
+    // Persist and report once a round of fetches has completed
+    if (has_results && pending_fetches == 0)
+    {
+        if (is_cache_file_dirty && cache_file_path)
+        {
+            schedule_store_save(cache_file_path);
+            is_cache_file_dirty = false;
+        }
+        log_schedule_stats();
     }
 
-    return get_lesson(index);
+    return changed;
+}
+
+bool take_current_day_update(void)
+{
+    bool updated = is_current_day_updated;
+    is_current_day_updated = false;
+    return updated;
+}
+
+bool has_pending_schedule_fetches(void)
+{
+    return pending_fetches > 0;
 }
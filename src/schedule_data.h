@@ -1,25 +1,35 @@
 ﻿#ifndef SCHEDULE_DATA_H
 #define SCHEDULE_DATA_H
 
+#include "lesson_day.h"
+#include <stdbool.h>
 #include <stdint.h>
 
 struct tm;
 
 /**
- * Structure representing a single lesson in the schedule.
- * Contains information about the lesson type, subject, teacher, and time.
+ * Availability of the schedule for a date.
  */
-typedef struct {
-    char* type;             /* Type of the lesson */
-    char* subject;          /* Subject of the lesson */
-    char* teacher;          /* Name of the teacher */
-    char* groups;           /* Groups of the lesson */
-    uint32_t color;         /* Background color for the lesson type */
-    int start_hour;         /* Start hour of the lesson */
-    int start_minute;       /* Start minute of the lesson */
-    int end_hour;           /* End hour of the lesson */
-    int end_minute;         /* End minute of the lesson */
-} lesson_t;
+typedef enum {
+    SCHEDULE_STATE_PENDING,     /* A background fetch for the date is in progress */
+    SCHEDULE_STATE_READY,       /* The schedule for the date is available */
+    SCHEDULE_STATE_FAILED       /* The last fetch for the date failed */
+} schedule_state_t;
+
+/**
+ * Starts the background fetching of schedule data.
+ * @return 0 on success, -1 on error.
+ * @note Must be called once before any other schedule data function.
+ */
+int init_schedule_data(void);
+
+/**
+ * Sets a function called from the fetch thread whenever a background fetch completes,
+ * so that process_schedule_fetch_results() can be run right away instead of on the next poll.
+ * @param notify Function to call, NULL to rely on polling; must be safe to call from any thread.
+ * @note Must be called before init_schedule_data().
+ */
+void set_schedule_fetch_notify(void (*notify)(void));
 
 /**
  * Sets the room ID for fetching schedule data.
@@ -28,31 +38,86 @@ typedef struct {
 void set_room_id(const char* room_id);
 
 /**
- * Retrieves a lesson by its index for the current date.
- * @param  index Index of the lesson to retrieve.
- * @return The lesson_t structure containing lesson details.
+ * Sets the file the schedule cache is persisted to and loads the days saved in it.
+ * Loaded days are available immediately and are fetched again in the background.
+ * @param path Pointer to a string containing the file path, NULL to disable persistence.
+ * @note Call after the cache limits are set and before the UI is initialized.
+ */
+void set_schedule_cache_file(const char* path);
+
+/**
+ * Sets how many days before and after a date prefetch_schedule() fetches.
+ * @param days_around Number of days on each side of the date, clamped to 14.
  */
-lesson_t get_lesson(int index);
+void set_prefetch_days(int days_around);
 
 /**
- * Gets the total number of lessons for the current date.
- * @return The number of lessons in the schedule.
+ * Sets the age after which an available day is fetched again in the background.
+ * The stale lessons keep being served until the new ones arrive, and are replaced only if they changed.
+ * @param max_age_s Seconds after a successful fetch before the day is revalidated.
  */
-int get_lesson_count(void);
+void set_schedule_max_age(uint32_t max_age_s);
 
 /**
- * Gets the total number of lessons for a specified date.
+ * Gets the lessons of a specified date for display.
+ * If the schedule for the date is not available yet, a background fetch is started
+ * and NULL is returned; use get_schedule_state_for_date() to tell it apart from an empty day.
+ * Call it once per render and read the lessons through lesson_day_get(). The day is an immutable
+ * snapshot that stays valid until the next process_schedule_fetch_results(); take a reference with
+ * lesson_day_retain() to keep it for longer, e.g. while it is displayed.
  * @param date  Pointer to a struct tm containing the date to query (year, month, day).
- * @return The number of lessons for the specified date.
+ * @return The lessons of the specified date, or NULL if they are not available;
+ *         lesson_day_count() accepts NULL as an empty day.
  */
-int get_lesson_count_for_date(struct tm* date);
+const lesson_day_t* get_lessons_for_date(struct tm* date);
 
 /**
- * Retrieves a lesson by its index for a specified date.
+ * Marks a date as the displayed one: its day is kept in memory and take_current_day_update()
+ * reports when its lessons are replaced. Call it once the lessons are actually shown.
+ * @param date  Pointer to a struct tm containing the displayed date (year, month, day), NULL if none.
+ */
+void set_displayed_schedule_date(const struct tm* date);
+
+/**
+ * Gets the availability of the schedule for a specified date.
  * @param date  Pointer to a struct tm containing the date to query (year, month, day).
- * @param index  Index of the lesson to retrieve.
- * @return The lesson_t structure containing lesson details.
+ * @return The state of the schedule for the specified date.
+ */
+schedule_state_t get_schedule_state_for_date(struct tm* date);
+
+/**
+ * Fetches the schedule of the days around a date in the background.
+ * Days already in memory or being fetched are skipped; fetches run in parallel
+ * after any fetch started by get_lessons_for_date().
+ * @param date  Pointer to a struct tm containing the center date (year, month, day).
+ */
+void prefetch_schedule(const struct tm* date);
+
+/**
+ * Fetches a day again in the background if it is older than the max-age, without waiting for it.
+ * Used for a date that stays displayed, e.g. today on an idle signage screen.
+ * @param date  Pointer to a struct tm containing the date (year, month, day).
+ */
+void revalidate_schedule(const struct tm* date);
+
+/**
+ * Applies completed background fetches to the schedule data.
+ * @return true if the schedule data changed.
+ * @note Must be called from the LVGL thread.
+ */
+bool process_schedule_fetch_results(void);
+
+/**
+ * Checks whether the lessons of the date set by set_displayed_schedule_date() were replaced by a background fetch
+ * since the last call, e.g. after a day loaded from the cache file was fetched again.
+ * @return true if the current date should be redrawn.
+ */
+bool take_current_day_update(void);
+
+/**
+ * Checks whether background fetches are still in progress.
+ * @return true if at least one fetch has not been processed yet.
  */
-lesson_t get_lesson_for_date(struct tm* date, int index);
+bool has_pending_schedule_fetches(void);
 
 #endif
@@ -0,0 +1,372 @@
+﻿#include "schedule_store.h"
+#include "schedule_cache.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ * File layout (all integers little-endian):
+ *   header: "SCHD", u32 version, u32 day count, u32 FNV-1a checksum of the payload
+ *   day:    u16 year, u8 month, u8 day, u16 lesson count, str room ID,
+ *           str ETag, str Last-Modified (empty if unknown)
+ *   lesson: u16 start minute of day, u16 end minute of day, u32 color,
+ *           str type, str subject, str teacher, str groups
+ *   str:    u16 length, bytes without terminator
+ */
+#define STORE_MAGIC "SCHD"
+#define STORE_VERSION 3
+#define STORE_HEADER_SIZE 16
+
+typedef struct {
+    uint8_t* data;
+    size_t size;
+    size_t capacity;
+    bool failed;
+} store_writer_t;
+
+typedef struct {
+    const uint8_t* data;
+    size_t size;
+    size_t offset;
+    bool failed;
+} store_reader_t;
+
+static uint32_t checksum(const uint8_t* data, size_t size)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void write_bytes(store_writer_t* writer, const void* bytes, size_t size)
+{
+    if (writer->failed || size == 0) return;
+
+    if (writer->size + size > writer->capacity)
+    {
+        size_t new_capacity = writer->capacity ? writer->capacity : 4096;
+        while (new_capacity < writer->size + size)
+        {
+            new_capacity *= 2;
+        }
+        uint8_t* new_data = realloc(writer->data, new_capacity);
+        if (!new_data)
+        {
+            writer->failed = true;
+            return;
+        }
+        writer->data = new_data;
+        writer->capacity = new_capacity;
+    }
+    memcpy(writer->data + writer->size, bytes, size);
+    writer->size += size;
+}
+
+static void write_uint(store_writer_t* writer, uint64_t value, size_t size)
+{
+    uint8_t bytes[8];
+    for (size_t i = 0; i < size; i++)
+    {
+        bytes[i] = (uint8_t)(value >> (8 * i));
+    }
+    write_bytes(writer, bytes, size);
+}
+
+static void write_string(store_writer_t* writer, const char* string)
+{
+    size_t length = string ? strlen(string) : 0;
+    if (length > UINT16_MAX) length = UINT16_MAX;
+    write_uint(writer, length, 2);
+    write_bytes(writer, string, length);
+}
+
+static uint64_t read_uint(store_reader_t* reader, size_t size)
+{
+    if (reader->failed || reader->offset + size > reader->size)
+    {
+        reader->failed = true;
+        return 0;
+    }
+
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; i++)
+    {
+        value |= (uint64_t)reader->data[reader->offset + i] << (8 * i);
+    }
+    reader->offset += size;
+    return value;
+}
+
+static char* read_string(store_reader_t* reader)
+{
+    size_t length = (size_t)read_uint(reader, 2);
+    if (reader->failed || reader->offset + length > reader->size)
+    {
+        reader->failed = true;
+        return NULL;
+    }
+
+    char* string = malloc(length + 1);
+    if (!string)
+    {
+        reader->failed = true;
+        return NULL;
+    }
+    memcpy(string, reader->data + reader->offset, length);
+    string[length] = '\0';
+    reader->offset += length;
+    return string;
+}
+
+// Reads a string and returns the reference of its pooled copy
+static string_ref_t read_interned_string(store_reader_t* reader)
+{
+    size_t length = (size_t)read_uint(reader, 2);
+    if (reader->failed || reader->offset + length > reader->size)
+    {
+        reader->failed = true;
+        return STRING_REF_INVALID;
+    }
+
+    string_ref_t ref = string_pool_intern((const char*)reader->data + reader->offset, length);
+    reader->offset += length;
+    if (ref == STRING_REF_INVALID) reader->failed = true;
+    return ref;
+}
+
+// Reads a string that is stored empty when absent
+static char* read_optional_string(store_reader_t* reader)
+{
+    char* string = read_string(reader);
+    if (string && string[0] == '\0')
+    {
+        free(string);
+        return NULL;
+    }
+    return string;
+}
+
+static bool read_day(store_reader_t* reader)
+{
+    struct tm date = { 0 };
+    date.tm_year = (int)read_uint(reader, 2) - 1900;
+    date.tm_mon = (int)read_uint(reader, 1) - 1;
+    date.tm_mday = (int)read_uint(reader, 1);
+    int lesson_count = (int)read_uint(reader, 2);
+    char* room_id = read_string(reader);
+    char* etag = read_optional_string(reader);
+    char* last_modified = read_optional_string(reader);
+
+    lesson_day_t* lessons = reader->failed ? NULL : lesson_day_create(lesson_count);
+    for (int i = 0; lessons && i < lesson_count && !reader->failed; i++)
+    {
+        lessons->start_minutes[i] = (uint16_t)read_uint(reader, 2);
+        lessons->end_minutes[i] = (uint16_t)read_uint(reader, 2);
+        lessons->colors[i] = (uint32_t)read_uint(reader, 4);
+        lessons->types[i] = read_interned_string(reader);
+        lessons->subjects[i] = read_interned_string(reader);
+        lessons->teachers[i] = read_interned_string(reader);
+        lessons->groups[i] = read_interned_string(reader);
+    }
+
+    if (reader->failed || !lessons)
+    {
+        lesson_day_release(lessons);
+        free(room_id);
+        free(etag);
+        free(last_modified);
+        return false;
+    }
+
+    // Days already fetched during this run are newer than the saved ones
+    schedule_cache_entry_t* entry = NULL;
+    if (!schedule_cache_find(room_id, &date))
+    {
+        entry = schedule_cache_insert(room_id, &date);
+    }
+    free(room_id);
+
+    if (!entry)
+    {
+        lesson_day_release(lessons);
+        free(etag);
+        free(last_modified);
+        return true;
+    }
+
+    schedule_cache_set_validators(entry, etag, last_modified);
+    schedule_cache_store(entry, lessons, SCHEDULE_STATE_READY);
+    entry->is_stale = true;
+    return true;
+}
+
+// Validates the header and loads every day of a mapped cache file
+static int read_store(store_reader_t* reader, const char* path)
+{
+    if (memcmp(reader->data, STORE_MAGIC, 4) != 0)
+    {
+        fprintf(stderr, "Schedule cache file has an unknown format: %s\n", path);
+        return -1;
+    }
+    reader->offset = 4;
+
+    uint32_t version = (uint32_t)read_uint(reader, 4);
+    uint32_t day_count = (uint32_t)read_uint(reader, 4);
+    uint32_t expected_checksum = (uint32_t)read_uint(reader, 4);
+    if (version != STORE_VERSION)
+    {
+        fprintf(stderr, "Schedule cache file version %u is not supported\n", (unsigned)version);
+        return -1;
+    }
+    if (checksum(reader->data + STORE_HEADER_SIZE, reader->size - STORE_HEADER_SIZE) != expected_checksum)
+    {
+        fprintf(stderr, "Schedule cache file is corrupted: %s\n", path);
+        return -1;
+    }
+
+    int loaded = 0;
+    for (uint32_t i = 0; i < day_count; i++)
+    {
+        if (!read_day(reader))
+        {
+            fprintf(stderr, "Schedule cache file is truncated: %s\n", path);
+            break;
+        }
+        loaded++;
+    }
+    return loaded;
+}
+
+int schedule_store_load(const char* path)
+{
+    if (!path) return -1;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size < STORE_HEADER_SIZE)
+    {
+        close(fd);
+        return -1;
+    }
+
+    size_t size = (size_t)file_stat.st_size;
+    void* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        fprintf(stderr, "Failed to map schedule cache file: %s\n", path);
+        return -1;
+    }
+
+    store_reader_t reader = { .data = data, .size = size };
+    int loaded = read_store(&reader, path);
+
+    munmap(data, size);
+    return loaded;
+}
+
+static void write_day(schedule_cache_entry_t* entry, void* user_data)
+{
+    store_writer_t* writer = (store_writer_t*)user_data;
+    if (entry->state != SCHEDULE_STATE_READY) return;
+
+    write_uint(writer, (uint64_t)(entry->date.tm_year + 1900), 2);
+    write_uint(writer, (uint64_t)(entry->date.tm_mon + 1), 1);
+    write_uint(writer, (uint64_t)entry->date.tm_mday, 1);
+    const lesson_day_t* lessons = entry->lessons;
+    int lesson_count = lesson_day_count(lessons);
+    write_uint(writer, (uint64_t)lesson_count, 2);
+    write_string(writer, entry->room_id);
+    write_string(writer, entry->etag);
+    write_string(writer, entry->last_modified);
+
+    for (int i = 0; i < lesson_count; i++)
+    {
+        write_uint(writer, lessons->start_minutes[i], 2);
+        write_uint(writer, lessons->end_minutes[i], 2);
+        write_uint(writer, lessons->colors[i], 4);
+        write_string(writer, string_pool_get(lessons->types[i]));
+        write_string(writer, string_pool_get(lessons->subjects[i]));
+        write_string(writer, string_pool_get(lessons->teachers[i]));
+        write_string(writer, string_pool_get(lessons->groups[i]));
+    }
+}
+
+static void count_day(schedule_cache_entry_t* entry, void* user_data)
+{
+    if (entry->state == SCHEDULE_STATE_READY)
+    {
+        (*(uint32_t*)user_data)++;
+    }
+}
+
+int schedule_store_save(const char* path)
+{
+    if (!path) return -1;
+
+    uint32_t day_count = 0;
+    schedule_cache_foreach(count_day, &day_count);
+
+    store_writer_t writer = { 0 };
+    write_bytes(&writer, STORE_MAGIC, 4);
+    write_uint(&writer, STORE_VERSION, 4);
+    write_uint(&writer, day_count, 4);
+    write_uint(&writer, 0, 4); // Checksum, patched below
+    schedule_cache_foreach(write_day, &writer);
+    if (writer.failed)
+    {
+        fprintf(stderr, "Failed to allocate memory for schedule cache file\n");
+        free(writer.data);
+        return -1;
+    }
+
+    uint32_t payload_checksum = checksum(writer.data + STORE_HEADER_SIZE, writer.size - STORE_HEADER_SIZE);
+    for (int i = 0; i < 4; i++)
+    {
+        writer.data[12 + i] = (uint8_t)(payload_checksum >> (8 * i));
+    }
+
+    char tmp_path[512];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+    int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        fprintf(stderr, "Failed to create schedule cache file: %s\n", tmp_path);
+        free(writer.data);
+        return -1;
+    }
+
+    size_t written = 0;
+    while (written < writer.size)
+    {
+        ssize_t result = write(fd, writer.data + written, writer.size - written);
+        if (result <= 0) break;
+        written += (size_t)result;
+    }
+    bool ok = written == writer.size && fsync(fd) == 0;
+    close(fd);
+    free(writer.data);
+
+    if (!ok || rename(tmp_path, path) != 0)
+    {
+        fprintf(stderr, "Failed to write schedule cache file: %s\n", path);
+        unlink(tmp_path);
+        return -1;
+    }
+
+    return (int)day_count;
+}
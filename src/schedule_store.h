@@ -0,0 +1,21 @@
+﻿#ifndef SCHEDULE_STORE_H
+#define SCHEDULE_STORE_H
+
+/**
+ * Loads the days saved by schedule_store_save() into the schedule cache.
+ * The file is memory-mapped and validated; loaded days are marked stale so that
+ * they are shown immediately and fetched again in the background.
+ * @param path  Path of the cache file.
+ * @return The number of loaded days, or -1 if the file is missing or invalid.
+ */
+int schedule_store_load(const char* path);
+
+/**
+ * Saves every available day of the schedule cache to a compact, versioned binary file.
+ * The file is written to a temporary path and renamed, so a crash never leaves a torn file.
+ * @param path  Path of the cache file.
+ * @return The number of saved days, or -1 on error.
+ */
+int schedule_store_save(const char* path);
+
+#endif
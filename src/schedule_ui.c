@@ -1,21 +1,43 @@
 ﻿#include "schedule_ui.h"
 #include "schedule_data.h"
+#include "lesson_card.h"
+#include "lesson_timeline.h"
+#include "ui_scheduler.h"
 #include "locale.h"
 #include "config.h"
 #include <lvgl/lvgl.h>
 #include <stdio.h>
 #include <time.h>
+#include <stdlib.h>
 #include <string.h>
 
 LV_IMG_DECLARE(calendar_icon)
 LV_IMG_DECLARE(theme_icon_light)
 LV_IMG_DECLARE(theme_icon_dark)
 
-#define MAX_NUMBER_OF_LESSONS 10
+#define LESSON_BLOCK_POOL_SIZE 10 // Enough blocks to cover the viewport and its margins
+#define VIEWPORT_MARGIN 100 // Pixels above and below the viewport whose lessons stay bound to blocks
+#define ESTIMATED_BLOCK_HEIGHT 200 // Height assumed for lessons that were never bound
+#define LIST_GAP 15
 #define POPUP_DURATION_MS 3000
+#define FETCH_POLL_PERIOD_MS 100
 
 static lv_obj_t* list_container;
-static lv_obj_t* blocks[MAX_NUMBER_OF_LESSONS]; // Store lessons blocks
+static lv_obj_t* blocks[LESSON_BLOCK_POOL_SIZE]; // Pool of lesson blocks, lesson i is bound to blocks[i % LESSON_BLOCK_POOL_SIZE]
+static int block_lessons[LESSON_BLOCK_POOL_SIZE]; // Lesson bound to each block, -1 if the block is hidden
+static lv_obj_t* top_spacer; // Stand in for the lessons above and below the bound ones
+static lv_obj_t* bottom_spacer;
+static int32_t* lesson_heights; // Measured height of each displayed lesson, 0 until it is bound
+static int lesson_heights_capacity = 0;
+static int32_t lessons_height = 0; // Height of every displayed lesson and its gap, estimates included
+static int window_first = 0; // First lesson bound to a block
+static int window_count = 0; // Number of lessons bound to blocks
+static int32_t window_top = 0; // Offset of the first bound lesson from the first lesson
+static bool is_updating_window = false;
+static int displayed_day_position = 0; // -1 for a past day, 0 for today, 1 for a future day
+static const lesson_day_t* displayed_lessons; // Snapshot the blocks are bound to, retained while displayed
+static lesson_timeline_t* displayed_timeline; // Start and end times of the displayed lessons
+static int active_lesson = -1; // Lesson in progress, -1 if none
 static struct tm current_display_date;
 static struct tm start_academic_date;
 static struct tm end_academic_date;
@@ -34,9 +56,31 @@ static lv_calendar_date_t highlighted_date; // Store the highlighted date
 static lv_obj_t* popup;
 static lv_timer_t* popup_timer;
 
+// Styles shared by every lesson card, a finished lesson is in the checked state
+static lv_style_t block_style;
+static lv_style_t progress_bar_style;
+static lv_style_t progress_indicator_style;
+static lv_style_t progress_indicator_done_style;
+
+// Styles holding the colors of the rest of the screen, the theme is switched by rewriting them
+static lv_style_t screen_style;
+static lv_style_t list_container_style;
+static lv_style_t date_label_style;
+static lv_style_t calendar_style;
+static lv_style_t calendar_arrow_style;
+static lv_style_t calendar_arrow_disabled_style;
+static lv_style_t calendar_close_button_style;
+
+static lv_timer_t* fetch_timer; // Polls background fetches while any are in progress
+static struct tm awaited_display_date; // Date to display once its schedule arrives
+static bool is_awaiting_display_date = false;
+
+static void show_day(struct tm* display_date, bool is_refresh);
+
 static lv_obj_t* theme_toggle_button;
 static bool is_dark_theme = false;
 static uint32_t inactive_duration_ms = 60000;
+static uint32_t day_switch_fade_ms = 0;
 
 void set_dark_theme(bool is_dark)
 {
@@ -48,22 +92,59 @@ void set_inactive_duration(uint32_t duration_ms)
     inactive_duration_ms = duration_ms;
 }
 
-static void inactivity_check_cb(lv_timer_t* timer)
+void set_day_switch_fade(uint32_t duration_ms)
+{
+    day_switch_fade_ms = duration_ms;
+}
+
+uint32_t get_inactivity_delay(void)
 {
-    (void)timer;
     lv_display_t* display = lv_display_get_default();
-    if (!display) return;
+    if (!display) return UINT32_MAX;
 
     uint32_t inactive_time_ms = lv_display_get_inactive_time(display);
-    if (inactive_time_ms >= inactive_duration_ms)
+    return inactive_time_ms >= inactive_duration_ms ? 0 : inactive_duration_ms - inactive_time_ms;
+}
+
+void show_today_schedule(void)
+{
+    // Get current time
+    time_t now = time(NULL);
+    struct tm* current_time = localtime(&now);
+
+    update_schedule_display(current_time);
+}
+
+static void fetch_timer_cb(lv_timer_t* timer)
+{
+    bool changed = process_schedule_fetch_results();
+
+    if (changed && is_awaiting_display_date &&
+        get_schedule_state_for_date(&awaited_display_date) != SCHEDULE_STATE_PENDING)
     {
-        // Get current time
-        time_t now = time(NULL);
-        struct tm* current_time = localtime(&now);
+        is_awaiting_display_date = false;
+        update_schedule_display(&awaited_display_date);
+    }
+    else if (!is_awaiting_display_date && take_current_day_update())
+    {
+        // Tested last: the update of the displayed day is kept while another date is awaited
+        // The displayed day was fetched again, rebuild it with the new lessons
+        struct tm displayed_date = current_display_date;
+        show_day(&displayed_date, true);
+    }
 
-        update_schedule_display(current_time);
+    if (!has_pending_schedule_fetches())
+    {
+        lv_timer_pause(timer);
+    }
+}
+
+void handle_schedule_fetch_results(void)
+{
+    if (fetch_timer && has_pending_schedule_fetches())
+    {
+        fetch_timer_cb(fetch_timer);
     }
-    //printf("Inactivity check: %d ms\n", inactive_time_ms);
 }
 
 static void popup_timer_cb(lv_timer_t* timer)
@@ -111,37 +192,94 @@ static void show_popup(const char* message)
     popup_timer = lv_timer_create(popup_timer_cb, POPUP_DURATION_MS, NULL);
 }
 
-static void style_progress_bar_and_labels(lv_obj_t* progress_bar, lv_obj_t* start_time_label, lv_obj_t* end_time_label, int progress)
+// Sets the colors of every shared style for the current theme
+static void set_theme_colors(void)
 {
-    if (is_dark_theme)
-    {
-        lv_obj_set_style_text_color(start_time_label, lv_color_hex(0xFFFFFF), 0);
-        lv_obj_set_style_text_color(end_time_label, lv_color_hex(0xFFFFFF), 0);
-        if (progress == 100)
-        {
-            lv_obj_set_style_bg_color(progress_bar, lv_color_hex(0x276f2f), LV_PART_INDICATOR);
-        }
-        else
-        {
-            lv_obj_set_style_bg_color(progress_bar, lv_color_hex(0x477285), LV_PART_INDICATOR);
-            lv_obj_set_style_bg_color(progress_bar, lv_color_hex(0xFFFFFF), LV_PART_MAIN);
-        }
-    }
-    else
+    lv_color_t text_color = is_dark_theme ? lv_color_hex(0xFFFFFF) : lv_color_hex(0x000000);
+
+    lv_style_set_bg_color(&screen_style, is_dark_theme ? lv_color_hex(0x303336) : lv_color_hex(0x2C72A5));
+    lv_style_set_bg_color(&list_container_style, is_dark_theme ? lv_color_hex(0x101012) : lv_color_hex(0xFFFFFF));
+    lv_style_set_text_color(&date_label_style, is_dark_theme ? lv_color_hex(0xFFFFFF) : lv_color_hex(0x2C72A5));
+    lv_style_set_bg_color(&calendar_style, is_dark_theme ? lv_color_hex(0x303336) : lv_color_hex(0xFFFFFF));
+    lv_style_set_text_color(&calendar_style, text_color);
+    lv_style_set_text_color(&calendar_arrow_style, is_dark_theme ? lv_color_hex(0xFFFFFF) : lv_color_hex(0x2C72A5));
+    lv_style_set_text_color(&calendar_arrow_disabled_style, is_dark_theme ? lv_color_hex(0x000000) : lv_color_hex(0xBBBBBB));
+    lv_style_set_bg_color(&calendar_close_button_style, is_dark_theme ? lv_color_hex(0x272727) : lv_color_hex(0x407AB2));
+
+    lv_style_set_bg_color(&block_style, is_dark_theme ? lv_color_hex(0x000000) : lv_color_hex(0xFFFFFF));
+    lv_style_set_text_color(&block_style, text_color);
+    lv_style_set_line_color(&block_style, text_color);
+
+    lv_style_set_bg_color(&progress_bar_style, is_dark_theme ? lv_color_hex(0xFFFFFF) : lv_color_hex(0x858585));
+    lv_style_set_bg_color(&progress_indicator_style, is_dark_theme ? lv_color_hex(0x477285) : lv_color_hex(0xaddff6));
+    lv_style_set_bg_color(&progress_indicator_done_style, is_dark_theme ? lv_color_hex(0x276f2f) : lv_color_hex(0x9ffea5));
+    lv_style_set_text_color(&progress_indicator_style, is_dark_theme ? lv_color_hex(0xFFFFFF) : lv_color_hex(0x285886));
+    lv_style_set_text_color(&progress_indicator_done_style, is_dark_theme ? lv_color_hex(0xFFFFFF) : lv_color_hex(0x276f2f));
+}
+
+static void init_styles(void)
+{
+    lv_style_init(&screen_style);
+    lv_style_init(&list_container_style);
+    lv_style_init(&date_label_style);
+    lv_style_init(&calendar_style);
+    lv_style_init(&calendar_arrow_style);
+    lv_style_init(&calendar_arrow_disabled_style);
+    lv_style_init(&calendar_close_button_style);
+
+    // Lesson cards are not styled by the default theme, every property they use is set here
+    lv_style_init(&block_style);
+    lv_style_set_width(&block_style, lv_pct(98));
+    lv_style_set_height(&block_style, LV_SIZE_CONTENT);
+    lv_style_set_bg_opa(&block_style, LV_OPA_COVER);
+    lv_style_set_border_width(&block_style, 1);
+    lv_style_set_border_color(&block_style, lv_color_hex(0x525252));
+    lv_style_set_radius(&block_style, 0);
+    lv_style_set_pad_all(&block_style, 16);
+    lv_style_set_pad_row(&block_style, 10);
+    lv_style_set_text_font(&block_style, &lv_font_my_montserrat_20);
+    lv_style_set_line_width(&block_style, 1);
+    lv_style_set_line_dash_width(&block_style, 2);
+    lv_style_set_line_dash_gap(&block_style, 2);
+
+    lv_style_init(&progress_bar_style);
+    lv_style_init(&progress_indicator_style);
+    lv_style_init(&progress_indicator_done_style);
+
+    set_theme_colors();
+}
+
+// Progress of a lesson on the displayed day, in percent
+static int get_lesson_progress(const lesson_day_t* lessons, int index, int current_minutes)
+{
+    int start_minutes = lessons->start_minutes[index];
+    int end_minutes = lessons->end_minutes[index];
+    if (current_minutes >= end_minutes) return 100;
+    if (current_minutes < start_minutes) return 0;
+    return ((current_minutes - start_minutes) * 100) / (end_minutes - start_minutes);
+}
+
+// Progress of a displayed lesson, in percent
+static int get_displayed_progress(int index, int current_minutes)
+{
+    if (displayed_day_position < 0) return 100;
+    if (displayed_day_position > 0) return 0;
+    return get_lesson_progress(displayed_lessons, index, current_minutes);
+}
+
+// Block a displayed lesson is bound to, NULL if the lesson is outside the window
+static lv_obj_t* get_lesson_block(int index)
+{
+    int slot = index % LESSON_BLOCK_POOL_SIZE;
+    return block_lessons[slot] == index ? blocks[slot] : NULL;
+}
+
+static void set_lesson_progress(int index, int progress)
+{
+    lv_obj_t* block = get_lesson_block(index);
+    if (block)
     {
-        if (progress == 100)
-        {
-            lv_obj_set_style_text_color(start_time_label, lv_color_hex(0x276f2f), 0);
-            lv_obj_set_style_text_color(end_time_label, lv_color_hex(0x276f2f), 0);
-            lv_obj_set_style_bg_color(progress_bar, lv_color_hex(0x9ffea5), LV_PART_INDICATOR);
-        }
-        else
-        {
-            lv_obj_set_style_text_color(start_time_label, lv_color_hex(0x285886), 0);
-            lv_obj_set_style_text_color(end_time_label, lv_color_hex(0x285886), 0);
-            lv_obj_set_style_bg_color(progress_bar, lv_color_hex(0xaddff6), LV_PART_INDICATOR);
-            lv_obj_set_style_bg_color(progress_bar, lv_color_hex(0x858585), LV_PART_MAIN);
-        }
+        lesson_card_set_progress(block, progress);
     }
 }
 
@@ -168,31 +306,27 @@ static void update_calendar_arrow_state(lv_obj_t* calendar)
     lv_obj_t* left_arrow = lv_obj_get_child(calendar_header, 0);
     lv_obj_t* right_arrow = lv_obj_get_child(calendar_header, 2);
 
-    // Enable/Disable left arrow
+    // Enable/Disable left arrow, its color follows the disabled state
     if (mktime(&prev_month) < mktime(&start_academic_date))
     {
         //printf("Left arrow disabled\n");
-        lv_obj_set_style_text_color(left_arrow, is_dark_theme ? lv_color_hex(0x000000) : lv_color_hex(0xBBBBBB), 0); // Disabled arrow color
         lv_obj_add_state(left_arrow, LV_STATE_DISABLED);
     }
     else
     {
         //printf("Left arrow enabled\n");
-        lv_obj_set_style_text_color(left_arrow, is_dark_theme ? lv_color_hex(0xFFFFFF) : lv_color_hex(0x2C72A5), 0); // Enabled arrow color
         lv_obj_remove_state(left_arrow, LV_STATE_DISABLED);
     }
 
-    // Enable/Disable right arrow
+    // Enable/Disable right arrow, its color follows the disabled state
     if (mktime(&next_month) > mktime(&end_academic_date))
     {
         //printf("Right arrow disabled\n");
-        lv_obj_set_style_text_color(right_arrow, is_dark_theme ? lv_color_hex(0x000000) : lv_color_hex(0xBBBBBB), 0); // Disabled arrow color
         lv_obj_add_state(right_arrow, LV_STATE_DISABLED);
     }
     else
     {
         //printf("Right arrow enabled\n");
-        lv_obj_set_style_text_color(right_arrow, is_dark_theme ? lv_color_hex(0xFFFFFF) : lv_color_hex(0x2C72A5), 0); // Enabled arrow color
         lv_obj_remove_state(right_arrow, LV_STATE_DISABLED);
     }
 }
@@ -264,66 +398,225 @@ static void toggle_theme_cb(lv_event_t* event)
 
     is_dark_theme = !is_dark_theme;
 
-    // Update screen background
-    lv_obj_set_style_bg_color(lv_screen_active(), is_dark_theme ? lv_color_hex(0x303336) : lv_color_hex(0x2C72A5), 0);
+    // Every themed object uses the shared styles, rewrite their colors and redraw once.
+    // Only colors change, so neither the layout nor the cached style properties are affected.
+    set_theme_colors();
+    lv_obj_invalidate(lv_screen_active());
+
+    // Update toggle button icon
+    lv_imagebutton_set_src(theme_toggle_button, LV_IMAGEBUTTON_STATE_RELEASED, is_dark_theme ? &theme_icon_dark : &theme_icon_light,
+        is_dark_theme ? &theme_icon_dark : &theme_icon_light, NULL);
+}
 
-    // Update list_container
-    lv_obj_set_style_bg_color(list_container, is_dark_theme ? lv_color_hex(0x101012) : lv_color_hex(0xFFFFFF), 0);
+// Creates a hidden lesson card with the shared styles, bind_lesson_block() fills it in
+static lv_obj_t* create_lesson_block(void)
+{
+    lv_obj_t* block = lesson_card_create(list_container);
+    lv_obj_add_style(block, &block_style, 0);
+    lv_obj_add_style(block, &progress_bar_style, LV_PART_ITEMS);
+    lv_obj_add_style(block, &progress_indicator_style, LV_PART_INDICATOR);
+    lv_obj_add_style(block, &progress_indicator_done_style, (lv_style_selector_t)(LV_PART_INDICATOR | LV_STATE_CHECKED));
+    lv_obj_add_flag(block, LV_OBJ_FLAG_HIDDEN);
+    return block;
+}
 
-    int lesson_count = get_lesson_count();
+// Shows a pooled card with the data of a lesson
+static void bind_lesson_block(lv_obj_t* block, const lesson_t* lesson, int progress)
+{
+    lesson_card_set_lesson(block, lesson);
+    lesson_card_set_progress(block, progress);
+    lv_obj_remove_flag(block, LV_OBJ_FLAG_HIDDEN);
+}
+
+// Creates an empty object that takes the place of lessons without a block
+static lv_obj_t* create_spacer(void)
+{
+    lv_obj_t* spacer = lv_obj_create(list_container);
+    lv_obj_remove_style_all(spacer);
+    lv_obj_set_width(spacer, 1);
+    lv_obj_remove_flag(spacer, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_add_flag(spacer, LV_OBJ_FLAG_HIDDEN);
+    return spacer;
+}
 
-    // Update blocks
-    for (int i = 0; i < lesson_count; i++)
+static void set_spacer_height(lv_obj_t* spacer, int32_t height)
+{
+    if (height > 0)
+    {
+        lv_obj_set_height(spacer, height);
+        lv_obj_remove_flag(spacer, LV_OBJ_FLAG_HIDDEN);
+    }
+    else
     {
-        if (blocks[i])
+        lv_obj_add_flag(spacer, LV_OBJ_FLAG_HIDDEN);
+    }
+}
+
+// Height of a displayed lesson, estimated until it has been bound once
+static int32_t get_lesson_height(int index)
+{
+    return lesson_heights[index] ? lesson_heights[index] : ESTIMATED_BLOCK_HEIGHT;
+}
+
+// Makes room for the heights of a day's lessons, all unknown
+static bool reset_lesson_heights(int lesson_count)
+{
+    if (lesson_count > lesson_heights_capacity)
+    {
+        int32_t* heights = realloc(lesson_heights, (size_t)lesson_count * sizeof(int32_t));
+        if (!heights)
+        {
+            fprintf(stderr, "Failed to allocate memory for lesson heights\n");
+            return false;
+        }
+        lesson_heights = heights;
+        lesson_heights_capacity = lesson_count;
+    }
+    memset(lesson_heights, 0, (size_t)lesson_count * sizeof(int32_t));
+    lessons_height = lesson_count * (ESTIMATED_BLOCK_HEIGHT + LIST_GAP);
+    return true;
+}
+
+// Binds a range of lessons to the pooled blocks in display order and hides the other blocks.
+// A lesson that stays in the window keeps its block, only the lessons entering it are bound.
+static void bind_window(int first, int count, int current_minutes)
+{
+    for (int i = 0; i < count; i++)
+    {
+        int index = first + i;
+        int slot = index % LESSON_BLOCK_POOL_SIZE;
+        if (!blocks[slot])
+        {
+            blocks[slot] = create_lesson_block();
+            block_lessons[slot] = -1;
+        }
+        if (block_lessons[slot] != index)
         {
-            lv_obj_set_style_bg_color(blocks[i], is_dark_theme ? lv_color_hex(0x000000) : lv_color_hex(0xFFFFFF), 0);
-            lv_obj_set_style_text_color(lv_obj_get_child(blocks[i], 4), is_dark_theme ? lv_color_hex(0xFFFFFF) : lv_color_hex(0x000000), 0); // Subject label
-            lv_obj_set_style_line_color(lv_obj_get_child(blocks[i], 5), is_dark_theme ? lv_color_hex(0xFFFFFF) : lv_color_hex(0x000000), 0); // Dashed line
-            lv_obj_set_style_text_color(lv_obj_get_child(lv_obj_get_child(blocks[i], 6), 0), is_dark_theme ? lv_color_hex(0xFFFFFF) : lv_color_hex(0x000000), 0); // Teacher label
-            lv_obj_set_style_text_color(lv_obj_get_child(lv_obj_get_child(blocks[i], 6), 1), is_dark_theme ? lv_color_hex(0xFFFFFF) : lv_color_hex(0x000000), 0); // Groups label
-
-            // Update progress bar and labels colors based on current progress
-            lv_obj_t* progress_bar = lv_obj_get_child(blocks[i], 0);
-            lv_obj_t* start_time_label = lv_obj_get_child(blocks[i], 1);
-            lv_obj_t* end_time_label = lv_obj_get_child(blocks[i], 2);
-            int progress = lv_bar_get_value(progress_bar);
-            style_progress_bar_and_labels(progress_bar, start_time_label, end_time_label, progress);
+            lesson_t lesson = lesson_day_get(displayed_lessons, index);
+            bind_lesson_block(blocks[slot], &lesson, get_displayed_progress(index, current_minutes));
+            block_lessons[slot] = index;
         }
+        // The date label and the top spacer come first
+        lv_obj_move_to_index(blocks[slot], 2 + i);
     }
 
-    // Update date_label
-    lv_obj_set_style_text_color(date_label, is_dark_theme ? lv_color_hex(0xFFFFFF) : lv_color_hex(0x2C72A5), 0);
+    for (int slot = 0; slot < LESSON_BLOCK_POOL_SIZE; slot++)
+    {
+        int index = block_lessons[slot];
+        if (blocks[slot] && index >= 0 && (index < first || index >= first + count))
+        {
+            lv_obj_add_flag(blocks[slot], LV_OBJ_FLAG_HIDDEN);
+            block_lessons[slot] = -1;
+        }
+    }
 
-    // Update calendar
-    lv_obj_set_style_bg_color(calendar, is_dark_theme ? lv_color_hex(0x303336) : lv_color_hex(0xFFFFFF), 0);
-    lv_obj_set_style_text_color(calendar, is_dark_theme ? lv_color_hex(0xFFFFFF) : lv_color_hex(0x000000), 0);
+    window_first = first;
+    window_count = count;
+}
 
-    // Update calendar header arrows
-    update_calendar_arrow_state(calendar);
+// Records the real heights of the bound lessons and sizes the spacers around them
+static void measure_window(void)
+{
+    lv_obj_update_layout(list_container);
 
-    // Update calendar close button
-    lv_obj_set_style_bg_color(calendar_close_button, is_dark_theme ? lv_color_hex(0x272727) : lv_color_hex(0x407AB2), 0);
+    int32_t window_height = 0;
+    for (int i = 0; i < window_count; i++)
+    {
+        int index = window_first + i;
+        int32_t height = lv_obj_get_height(get_lesson_block(index));
+        lessons_height += height - get_lesson_height(index);
+        lesson_heights[index] = height;
+        window_height += height + LIST_GAP;
+    }
 
-    // Update toggle button icon
-    lv_imagebutton_set_src(theme_toggle_button, LV_IMAGEBUTTON_STATE_RELEASED, is_dark_theme ? &theme_icon_dark : &theme_icon_light,
-        is_dark_theme ? &theme_icon_dark : &theme_icon_light, NULL);
+    set_spacer_height(top_spacer, window_top - LIST_GAP);
+    set_spacer_height(bottom_spacer, lessons_height - window_top - window_height - LIST_GAP);
 }
 
-static void clear_chedule_content()
+// Binds the lessons that intersect the viewport and its margins to blocks, the spacers stand in for the others
+static void update_visible_blocks(void)
 {
-    // Move and date_label to lv_screen_active before clearing
-    lv_obj_set_parent(date_label, lv_screen_active());
+    int lesson_count = lesson_day_count(displayed_lessons);
+    if (lesson_count == 0 || is_updating_window) return;
+
+    // Laying the list out below scrolls it again, which must not re-enter
+    is_updating_window = true;
 
-    // Clear existing content
-    lv_obj_clean(list_container);
-    for (int i = 0; i < MAX_NUMBER_OF_LESSONS; i++)
+    time_t now = time(NULL);
+    struct tm current_time;
+    localtime_r(&now, &current_time);
+    int current_minutes = current_time.tm_hour * 60 + current_time.tm_min;
+
+    // Measured heights can change how many lessons fit, so settle the window in a few passes
+    for (int pass = 0; pass < 3; pass++)
     {
-        blocks[i] = NULL;
+        // Offsets below are relative to the first lesson
+        int32_t lessons_y = lv_obj_get_y(date_label) + lv_obj_get_height(date_label) + LIST_GAP;
+        int32_t view_top = lv_obj_get_scroll_y(list_container) - lessons_y - VIEWPORT_MARGIN;
+        int32_t view_bottom = view_top + lv_obj_get_content_height(list_container) + 2 * VIEWPORT_MARGIN;
+
+        // Slide the window from its last position, so scrolling costs only the lessons that were crossed
+        int first = window_first;
+        int32_t top = window_top;
+        while (first > 0 && top > view_top)
+        {
+            first--;
+            top -= get_lesson_height(first) + LIST_GAP;
+        }
+        while (first < lesson_count - 1 && top + get_lesson_height(first) < view_top)
+        {
+            top += get_lesson_height(first) + LIST_GAP;
+            first++;
+        }
+
+        int count = 0;
+        int32_t bottom = top;
+        while (first + count < lesson_count && count < LESSON_BLOCK_POOL_SIZE && bottom < view_bottom)
+        {
+            bottom += get_lesson_height(first + count) + LIST_GAP;
+            count++;
+        }
+
+        if (first == window_first && count == window_count) break;
+
+        window_top = top;
+        bind_window(first, count, current_minutes);
+        measure_window();
     }
 
-    // Return and date_label to list_container
-    lv_obj_set_parent(date_label, list_container);
+    is_updating_window = false;
+}
+
+static void list_scroll_cb(lv_event_t* event)
+{
+    (void)event;
+
+    update_visible_blocks();
+}
+
+static void clear_chedule_content()
+{
+    // Hide the blocks, they are kept for the next date
+    for (int slot = 0; slot < LESSON_BLOCK_POOL_SIZE; slot++)
+    {
+        if (blocks[slot])
+        {
+            // The snapshot the card points into is released below
+            lv_obj_add_flag(blocks[slot], LV_OBJ_FLAG_HIDDEN);
+            lesson_card_set_lesson(blocks[slot], NULL);
+        }
+        block_lessons[slot] = -1;
+    }
+    set_spacer_height(top_spacer, 0);
+    set_spacer_height(bottom_spacer, 0);
+    window_first = 0;
+    window_count = 0;
+    window_top = 0;
+    lesson_day_release(displayed_lessons);
+    displayed_lessons = NULL;
+    lesson_timeline_free(displayed_timeline);
+    displayed_timeline = NULL;
+    active_lesson = -1;
 }
 
 static void highlight_calendar_date(struct tm* display_date)
@@ -335,6 +628,26 @@ static void highlight_calendar_date(struct tm* display_date)
     lv_calendar_set_highlighted_dates(calendar, &highlighted_date, 1);
 }
 
+// Hides the list while a day is built in it, so the cards and spacers being rebound queue
+// no invalidations of their own. A half-built day is never drawn in any case: LVGL renders
+// only after update_schedule_display() returns.
+static void begin_day_switch(void)
+{
+    lv_obj_add_flag(list_container, LV_OBJ_FLAG_HIDDEN);
+}
+
+// Lays out the finished day and shows it, which invalidates the list as one area
+// instead of one area per rebound card and spacer
+static void end_day_switch(void)
+{
+    lv_obj_update_layout(list_container);
+    lv_obj_remove_flag(list_container, LV_OBJ_FLAG_HIDDEN);
+    if (day_switch_fade_ms > 0)
+    {
+        lv_obj_fade_in(list_container, day_switch_fade_ms, 0);
+    }
+}
+
 void update_schedule_display(struct tm* display_date)
 {
     if (!list_container || !date_label || !display_date) return;
@@ -344,9 +657,24 @@ void update_schedule_display(struct tm* display_date)
         current_display_date.tm_mon == display_date->tm_mon &&
         current_display_date.tm_mday == display_date->tm_mday)
     {
+        is_awaiting_display_date = false;
+
+        // Keep a date that stays on screen up to date, the new lessons are shown by fetch_timer_cb()
+        revalidate_schedule(display_date);
+        if (has_pending_schedule_fetches())
+        {
+            lv_timer_resume(fetch_timer);
+        }
         return;
     }
 
+    show_day(display_date, false);
+}
+
+// Builds the list for a date. A refresh rebuilds the displayed date with refetched lessons:
+// it leaves the calendar open and shows an empty day instead of refusing it with a popup.
+static void show_day(struct tm* display_date, bool is_refresh)
+{
     // Get current time
     time_t now = time(NULL);
     struct tm* current_time = localtime(&now);
@@ -355,36 +683,69 @@ void update_schedule_display(struct tm* display_date)
                      display_date->tm_mon == current_time->tm_mon &&
                      display_date->tm_mday == current_time->tm_mday);
 
-    // Get total number of lessons
-    int lesson_count = get_lesson_count_for_date(display_date);
+    // Look the day up once, the blocks below are built from this snapshot
+    const lesson_day_t* lessons = get_lessons_for_date(display_date);
+    int lesson_count = lesson_day_count(lessons);
 
-    if (is_today && lesson_count == 0)
+    // Fetch the neighbouring days so that calendar browsing is served from memory
+    prefetch_schedule(display_date);
+    if (has_pending_schedule_fetches())
     {
-        lv_label_set_text(date_label, "На сегодня занятий нет");
-        clear_chedule_content();
-        highlight_calendar_date(display_date);
-        memcpy(&current_display_date, display_date, sizeof(struct tm));
-        close_calendar_cb(NULL);
+        lv_timer_resume(fetch_timer);
+    }
+
+    // The schedule is being fetched in the background, display it once it arrives
+    if (get_schedule_state_for_date(display_date) == SCHEDULE_STATE_PENDING)
+    {
+        awaited_display_date = *display_date;
+        is_awaiting_display_date = true;
         return;
     }
-    else if (!is_today && lesson_count == 0)
+    is_awaiting_display_date = false;
+
+    if (!is_today && lesson_count == 0 && !is_refresh)
     {
         show_popup("Нет занятий на выбранную дату");
         return;
     }
 
-    char date_str[64];
-    snprintf(date_str, sizeof(date_str), "%s, %d %s %d",
-        days_of_week[display_date->tm_wday], display_date->tm_mday,
-        months[display_date->tm_mon], display_date->tm_year + 1900);
-    lv_label_set_text(date_label, date_str);
+    begin_day_switch();
+
+    if (is_today && lesson_count == 0)
+    {
+        lv_label_set_text(date_label, "На сегодня занятий нет");
+    }
+    else
+    {
+        char date_str[64];
+        snprintf(date_str, sizeof(date_str), "%s, %d %s %d",
+            days_of_week[display_date->tm_wday], display_date->tm_mday,
+            months[display_date->tm_mon], display_date->tm_year + 1900);
+        lv_label_set_text(date_label, date_str);
+    }
 
     clear_chedule_content();
     highlight_calendar_date(display_date);
     memcpy(&current_display_date, display_date, sizeof(struct tm));
-    close_calendar_cb(NULL);
+    set_displayed_schedule_date(display_date);
+    if (!is_refresh)
+    {
+        close_calendar_cb(NULL);
+    }
+    ui_scheduler_reschedule(); // The return to today is due one inactive duration from now
+    if (lesson_count == 0 || !reset_lesson_heights(lesson_count))
+    {
+        end_day_switch();
+        return;
+    }
+    displayed_lessons = lesson_day_retain(lessons);
+    displayed_timeline = lesson_timeline_create(lessons);
 
     int current_minutes = current_time->tm_hour * 60 + current_time->tm_min;
+    if (is_today)
+    {
+        active_lesson = lesson_timeline_find(displayed_timeline, current_minutes);
+    }
 
     // Compare dates (ignoring time)
     int is_past_date = 0, is_future_date = 0;
@@ -403,152 +764,17 @@ void update_schedule_display(struct tm* display_date)
         is_future_date = 1;
     }
 
-    // Create a block for each lesson
-    for (int i = 0; i < lesson_count; i++)
-    {
-        lesson_t lesson = get_lesson_for_date(display_date, i);
-
-        // Create block container
-        lv_obj_t* block = lv_obj_create(list_container);
-        lv_obj_set_size(block, lv_pct(98), LV_SIZE_CONTENT);
-        lv_obj_set_style_bg_color(block, is_dark_theme ? lv_color_hex(0x000000) : lv_color_hex(0xFFFFFF), 0);
-        lv_obj_set_style_border_width(block, 1, 0);
-        lv_obj_set_style_border_color(block, lv_color_hex(0x525252), 0);
-        lv_obj_set_style_radius(block, 0, 0);
-        lv_obj_remove_flag(block, LV_OBJ_FLAG_SCROLLABLE);
-        lv_obj_set_scroll_dir(block, LV_DIR_NONE);
-        lv_obj_set_scrollbar_mode(block, LV_SCROLLBAR_MODE_OFF);
-        lv_obj_set_layout(block, LV_LAYOUT_FLEX);
-        lv_obj_set_flex_flow(block, LV_FLEX_FLOW_COLUMN);
-        lv_obj_set_flex_align(block, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
-        blocks[i] = block;
-
-        // Progress bar
-        lv_obj_t* progress_bar = lv_bar_create(block);
-        lv_obj_set_size(progress_bar, lv_pct(100), 30);
-        lv_bar_set_range(progress_bar, 0, 100);
-        lv_obj_set_style_radius(progress_bar, 0, LV_PART_MAIN);
-        lv_obj_set_style_radius(progress_bar, 0, LV_PART_INDICATOR);
-
-        // Calculate progress
-        int progress = 0;
-        if (is_past_date)
-        {
-            progress = 100;
-        }
-        else if (is_future_date)
-        {
-            progress = 0;
-        }
-        else
-        {
-            int start_minutes = lesson.start_hour * 60 + lesson.start_minute;
-            int end_minutes = lesson.end_hour * 60 + lesson.end_minute;
-            if (current_minutes > end_minutes)
-            {
-                progress = 100;
-            }
-            else if (current_minutes >= start_minutes && current_minutes <= end_minutes)
-            {
-                progress = ((current_minutes - start_minutes) * 100) / (end_minutes - start_minutes);
-            }
-        }
-        lv_bar_set_value(progress_bar, progress, LV_ANIM_ON);
-
-        char buffer[6];
-
-        // Start time label
-        lv_obj_t* start_time_label = lv_label_create(block);
-        snprintf(buffer, sizeof(buffer), "%02d:%02d", lesson.start_hour, lesson.start_minute);
-        lv_label_set_text(start_time_label, buffer);
-        lv_obj_set_style_text_font(start_time_label, &lv_font_my_montserrat_20, 0);
-        lv_obj_set_style_text_align(start_time_label, LV_TEXT_ALIGN_LEFT, 0);
-        lv_obj_add_flag(start_time_label, LV_OBJ_FLAG_FLOATING);
-        lv_obj_align_to(start_time_label, progress_bar, LV_ALIGN_LEFT_MID, 5, -1);
-
-        // End time label
-        lv_obj_t* end_time_label = lv_label_create(block);
-        snprintf(buffer, sizeof(buffer), "%02d:%02d", lesson.end_hour, lesson.end_minute);
-        lv_label_set_text(end_time_label, buffer);
-        lv_obj_set_style_text_font(end_time_label, &lv_font_my_montserrat_20, 0);
-        lv_obj_set_style_text_align(end_time_label, LV_TEXT_ALIGN_RIGHT, 0);
-        lv_obj_add_flag(end_time_label, LV_OBJ_FLAG_FLOATING);
-        lv_obj_align_to(end_time_label, progress_bar, LV_ALIGN_RIGHT_MID, -5, -1);
-
-        // Set colors for progress bar and labels
-        style_progress_bar_and_labels(progress_bar, start_time_label, end_time_label, progress);
-
-        // Type label
-        lv_obj_t* type_label = lv_label_create(block);
-        lv_label_set_text(type_label, lesson.type);
-        lv_obj_set_width(type_label, lv_pct(100));
-        lv_obj_set_style_text_font(type_label, &lv_font_my_montserrat_20, 0);
-        lv_obj_set_style_text_color(type_label, lv_color_hex(0xFFFFFF), 0);
-        lv_obj_set_style_text_align(type_label, LV_TEXT_ALIGN_CENTER, 0);
-        lv_obj_set_style_bg_opa(type_label, LV_OPA_COVER, 0);
-        lv_obj_set_style_pad_all(type_label, 5, 0);
-        lv_obj_set_style_bg_color(type_label, lv_color_hex(lesson.color), 0);
-
-        // Subject label (WRAP)
-        lv_obj_t* subject_label = lv_label_create(block);
-        lv_label_set_text(subject_label, lesson.subject);
-        lv_label_set_long_mode(subject_label, LV_LABEL_LONG_WRAP);
-        lv_obj_set_width(subject_label, lv_pct(100));
-        lv_obj_set_style_text_font(subject_label, &lv_font_my_montserrat_20, 0);
-        lv_obj_set_style_text_color(subject_label, is_dark_theme ? lv_color_hex(0xFFFFFF) : lv_color_hex(0x000000), 0);
-        lv_obj_set_style_pad_top(subject_label, 5, 0);
-        lv_obj_set_style_pad_bottom(subject_label, 10, 0);
-
-        // Dashed line
-        lv_coord_t block_width = lv_obj_get_width(block);
-        static lv_point_precise_t line_points[2];
-        line_points[0] = (lv_point_precise_t){ 0, 0 };
-        line_points[1] = (lv_point_precise_t){ block_width, 0 };
-        lv_obj_t* line = lv_line_create(block);
-        lv_line_set_points(line, line_points, 2);
-        lv_obj_set_style_line_color(line, is_dark_theme ? lv_color_hex(0xFFFFFF) : lv_color_hex(0x000000), 0);
-        lv_obj_set_style_line_width(line, 1, 0);
-        lv_obj_set_style_line_dash_width(line, 2, 0);
-        lv_obj_set_style_line_dash_gap(line, 2, 0);
-        lv_obj_set_width(line, lv_pct(100));
-
-        // Labels container for teacher and groups
-        lv_obj_t* labels_container = lv_obj_create(block);
-        lv_obj_set_size(labels_container, lv_pct(100), LV_SIZE_CONTENT);
-        lv_obj_set_layout(labels_container, LV_LAYOUT_FLEX);
-        lv_obj_set_flex_flow(labels_container, LV_FLEX_FLOW_ROW);
-        lv_obj_set_flex_align(labels_container, LV_FLEX_ALIGN_SPACE_BETWEEN, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
-        lv_obj_set_style_pad_all(labels_container, 0, 0);
-        lv_obj_set_style_border_width(labels_container, 0, 0);
-        lv_obj_set_style_bg_opa(labels_container, LV_OPA_TRANSP, 0);
-
-        // Teacher label
-        lv_obj_t* teacher_label = lv_label_create(labels_container);
-        lv_label_set_text(teacher_label, lesson.teacher);
-        lv_label_set_long_mode(teacher_label, LV_LABEL_LONG_WRAP);
-        lv_obj_set_width(teacher_label, lv_pct(45));
-        lv_obj_set_style_text_font(teacher_label, &lv_font_my_montserrat_20, 0);
-        lv_obj_set_style_text_color(teacher_label, is_dark_theme ? lv_color_hex(0xFFFFFF) : lv_color_hex(0x000000), 0);
-        lv_obj_set_style_text_align(teacher_label, LV_TEXT_ALIGN_LEFT, 0);
-
-        // Groups label
-        lv_obj_t* groups_label = lv_label_create(labels_container);
-        lv_label_set_text(groups_label, lesson.groups);
-        lv_label_set_long_mode(groups_label, LV_LABEL_LONG_WRAP);
-        lv_obj_set_width(groups_label, lv_pct(45));
-        lv_obj_set_style_text_font(groups_label, &lv_font_my_montserrat_20, 0);
-        lv_obj_set_style_text_color(groups_label, is_dark_theme ? lv_color_hex(0xFFFFFF) : lv_color_hex(0x000000), 0);
-        lv_obj_set_style_text_align(groups_label, LV_TEXT_ALIGN_RIGHT, 0);
-    }
+    displayed_day_position = is_past_date ? -1 : (is_future_date ? 1 : 0);
+
+    // Bind blocks to the lessons on screen only, more are bound while scrolling
+    lv_obj_scroll_to_y(list_container, 0, LV_ANIM_OFF);
+    update_visible_blocks();
+    end_day_switch();
 }
 
 void update_progress_bar(void)
 {
-    if (!list_container) return;
-
-    // Get total number of lessons
-    int lesson_count = get_lesson_count();
-    if (lesson_count == 0) return;
+    if (!list_container || !displayed_lessons) return;
 
     // Get current time
     time_t now = time(NULL);
@@ -561,39 +787,28 @@ void update_progress_bar(void)
         current_display_date.tm_mday == current_time->tm_mday);
     if (!is_today) return;
 
-    // Update progress bar of current lesson
-    for (int i = 0; i < lesson_count; i++)
+    int active = lesson_timeline_find(displayed_timeline, current_minutes);
+    if (active != active_lesson)
     {
-        if (blocks[i])
+        // A start or end time was crossed: settle every bound bar, which also covers clock adjustments.
+        // Lessons outside the window get their progress when they are bound.
+        for (int i = window_first; i < window_first + window_count; i++)
         {
-            lesson_t lesson = get_lesson(i);
-            int start_minutes = lesson.start_hour * 60 + lesson.start_minute;
-            int end_minutes = lesson.end_hour * 60 + lesson.end_minute;
-            int progress = 0;
-
-            if (current_minutes > end_minutes)
-            {
-                progress = 100;
-            }
-            else if (current_minutes >= start_minutes && current_minutes <= end_minutes)
-            {
-                progress = ((current_minutes - start_minutes) * 100) / (end_minutes - start_minutes);
-            }
-
-            lv_obj_t* progress_bar = lv_obj_get_child(blocks[i], 0);
-            lv_bar_set_value(progress_bar, progress, LV_ANIM_ON);
-
-            // Update colors based on new progress
-            lv_obj_t* start_time_label = lv_obj_get_child(blocks[i], 1);
-            lv_obj_t* end_time_label = lv_obj_get_child(blocks[i], 2);
-            style_progress_bar_and_labels(progress_bar, start_time_label, end_time_label, progress);
+            set_lesson_progress(i, get_lesson_progress(displayed_lessons, i, current_minutes));
         }
+        active_lesson = active;
+    }
+    else if (active >= 0)
+    {
+        // Only the lesson in progress moves between boundaries
+        set_lesson_progress(active, get_lesson_progress(displayed_lessons, active, current_minutes));
     }
 }
 
 void init_schedule_ui(void)
 {
-    lv_obj_set_style_bg_color(lv_screen_active(), is_dark_theme ? lv_color_hex(0x303336) : lv_color_hex(0x2C72A5), 0);
+    init_styles();
+    lv_obj_add_style(lv_screen_active(), &screen_style, 0);
 
     // Create theme toggle button
     theme_toggle_button = lv_imagebutton_create(lv_screen_active());
@@ -629,22 +844,27 @@ void init_schedule_ui(void)
     lv_obj_align(list_container, LV_ALIGN_BOTTOM_MID, 0, 0);
     lv_obj_set_scroll_dir(list_container, LV_DIR_VER); // Vertical scrolling only
     lv_obj_set_scrollbar_mode(list_container, LV_SCROLLBAR_MODE_ON);
-    lv_obj_set_style_bg_color(list_container, is_dark_theme ? lv_color_hex(0x101012) : lv_color_hex(0xFFFFFF), 0);
+    lv_obj_add_style(list_container, &list_container_style, 0);
     lv_obj_set_style_border_width(list_container, 0, 0);
     lv_obj_set_style_radius(list_container, 0, 0);
     lv_obj_add_flag(list_container, LV_OBJ_FLAG_SCROLLABLE);
     lv_obj_set_layout(list_container, LV_LAYOUT_FLEX);
     lv_obj_set_flex_flow(list_container, LV_FLEX_FLOW_COLUMN);
     lv_obj_set_flex_align(list_container, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
-    lv_obj_set_style_pad_gap(list_container, 15, 0);
+    lv_obj_set_style_pad_gap(list_container, LIST_GAP, 0);
+    lv_obj_add_event_cb(list_container, list_scroll_cb, LV_EVENT_SCROLL, NULL);
 
     // Calendar date
     date_label = lv_label_create(list_container);
     lv_label_set_text(date_label, "На сегодня занятий нет");
     lv_obj_set_style_text_font(date_label, &lv_font_my_montserrat_20, 0);
-    lv_obj_set_style_text_color(date_label, is_dark_theme ? lv_color_hex(0xFFFFFF) : lv_color_hex(0x2C72A5), 0);
+    lv_obj_add_style(date_label, &date_label_style, 0);
     lv_obj_set_style_pad_all(date_label, 5, 0);
 
+    // Spacers taking the place of the lessons above and below the bound blocks
+    top_spacer = create_spacer();
+    bottom_spacer = create_spacer();
+
     // Сalendar container
     calendar_container = lv_obj_create(lv_screen_active());
     lv_obj_remove_style_all(calendar_container);
@@ -665,8 +885,7 @@ void init_schedule_ui(void)
     calendar = lv_calendar_create(calendar_container);
     lv_obj_set_size(calendar, 300, 350);
     lv_obj_center(calendar);
-    lv_obj_set_style_bg_color(calendar, is_dark_theme ? lv_color_hex(0x303336) : lv_color_hex(0xFFFFFF), 0);
-    lv_obj_set_style_text_color(calendar, is_dark_theme ? lv_color_hex(0xFFFFFF) : lv_color_hex(0x000000), 0);
+    lv_obj_add_style(calendar, &calendar_style, 0);
     lv_obj_set_style_border_width(calendar, 0, 0);
 
     // Change calendar day buttons style
@@ -689,6 +908,8 @@ void init_schedule_ui(void)
     lv_obj_set_style_bg_opa(left_arrow, LV_OPA_TRANSP, (lv_style_selector_t)(LV_PART_MAIN | LV_STATE_PRESSED));
     lv_obj_set_style_border_width(left_arrow, 0, (lv_style_selector_t)(LV_PART_MAIN | LV_STATE_DEFAULT));
     lv_obj_set_style_shadow_width(left_arrow, 0, (lv_style_selector_t)(LV_PART_MAIN | LV_STATE_DEFAULT));
+    lv_obj_add_style(left_arrow, &calendar_arrow_style, 0);
+    lv_obj_add_style(left_arrow, &calendar_arrow_disabled_style, LV_STATE_DISABLED);
 
     // Style for header (year and month) (child 1)
     lv_obj_set_style_text_font(lv_obj_get_child(calendar_header, 1), &lv_font_my_montserrat_14, 0);
@@ -699,6 +920,8 @@ void init_schedule_ui(void)
     lv_obj_set_style_bg_opa(right_arrow, LV_OPA_TRANSP, (lv_style_selector_t)(LV_PART_MAIN | LV_STATE_PRESSED));
     lv_obj_set_style_border_width(right_arrow, 0, (lv_style_selector_t)(LV_PART_MAIN | LV_STATE_DEFAULT));
     lv_obj_set_style_shadow_width(right_arrow, 0, (lv_style_selector_t)(LV_PART_MAIN | LV_STATE_DEFAULT));
+    lv_obj_add_style(right_arrow, &calendar_arrow_style, 0);
+    lv_obj_add_style(right_arrow, &calendar_arrow_disabled_style, LV_STATE_DISABLED);
 
     lv_obj_add_event_cb(calendar, calendar_event_cb, LV_EVENT_ALL, NULL);
     lv_obj_add_event_cb(lv_obj_get_child(calendar_header, 0), prev_event_cb, LV_EVENT_CLICKED, calendar);
@@ -707,7 +930,7 @@ void init_schedule_ui(void)
     // Сalendar сlose button
     calendar_close_button = lv_button_create(calendar);
     lv_obj_set_size(calendar_close_button, lv_pct(100), 40);
-    lv_obj_set_style_bg_color(calendar_close_button, is_dark_theme ? lv_color_hex(0x272727) : lv_color_hex(0x407AB2), 0);
+    lv_obj_add_style(calendar_close_button, &calendar_close_button_style, 0);
     lv_obj_set_style_margin_all(calendar_close_button, 8, 0);
     lv_obj_t* close_label = lv_label_create(calendar_close_button);
     lv_label_set_text(close_label, "Закрыть");
@@ -740,7 +963,8 @@ void init_schedule_ui(void)
     end_academic_date.tm_mday = 31;
     mktime(&end_academic_date);
 
-    lv_timer_create(inactivity_check_cb, 1000, NULL);
+    fetch_timer = lv_timer_create(fetch_timer_cb, FETCH_POLL_PERIOD_MS, NULL);
+    lv_timer_pause(fetch_timer);
 
     update_schedule_display(current_date);
     lv_calendar_set_month_shown(calendar, current_date->tm_year + 1900, current_date->tm_mon + 1);
@@ -22,11 +22,30 @@ void update_schedule_display(struct tm* date);
 /**
  * Updates the progress bar for the current lesson.
  * Updates only the progress bar of the active lesson (if any) for the current date, based on the current time.
- * Skips updates for non-current dates or if no lesson is active.
- * @note Should be called periodically (e.g., every minute) to reflect real-time progress.
+ * The lesson in progress is found in the timeline of the displayed day; every bar is settled
+ * only when a lesson starts or ends. Skips updates for non-current dates or if no lesson is active.
+ * @note Called by the UI scheduler at every minute rollover.
  */
 void update_progress_bar(void);
 
+/**
+ * Applies completed background fetches right away instead of at the next poll.
+ * @note Must be called from the LVGL thread, e.g. when the fetch thread wakes up the run loop.
+ */
+void handle_schedule_fetch_results(void);
+
+/**
+ * Gets the time left before the screen is considered inactive.
+ * @return Milliseconds until the inactive duration elapses, 0 if it has elapsed.
+ */
+uint32_t get_inactivity_delay(void);
+
+/**
+ * Displays the schedule of the current date, or keeps it fresh if it is already displayed.
+ * Used once the screen has been left inactive, including after the date changed at midnight.
+ */
+void show_today_schedule(void);
+
 /**
  * Set the ui theme state
  * @param is_dark Boolean value:
@@ -41,4 +60,10 @@ void set_dark_theme(bool is_dark);
  */
 void set_inactive_duration(uint32_t duration_ms);
 
+/**
+ * Sets the fade-in of a newly displayed day.
+ * @param duration_ms Duration of the fade-in in milliseconds, 0 to show the day at once.
+ */
+void set_day_switch_fade(uint32_t duration_ms);
+
 #endif
@@ -0,0 +1,152 @@
+﻿#include "string_pool.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Strings are copied into chunks that are never moved, so pooled strings stay valid.
+// A reference holds a 16-bit offset, so regular chunks are 64 KB; longer strings get a chunk of their own.
+#define POOL_CHUNK_SIZE (64 * 1024)
+#define POOL_MAX_CHUNKS 1024
+#define POOL_INITIAL_SLOTS 256
+
+// Open-addressing hash table of the pooled strings
+typedef struct {
+    string_ref_t ref;
+    size_t length;
+    uint32_t hash;
+    bool used;
+} pool_slot_t;
+
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+// Fixed table, so that resolving a reference needs no lock
+static char* chunks[POOL_MAX_CHUNKS];
+static uint32_t chunk_count = 0;
+static size_t current_chunk_used = 0;   /* Bytes used in the last chunk */
+static size_t current_chunk_size = 0;   /* Size of the last chunk */
+static pool_slot_t* slots = NULL;
+static size_t slot_count = 0;
+static string_pool_stats_t stats;
+
+static uint32_t hash_string(const char* string, size_t length)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++)
+    {
+        hash ^= (uint8_t)string[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Doubles the table, keeping the load factor below one half
+static bool grow_slots(void)
+{
+    size_t new_count = slot_count ? slot_count * 2 : POOL_INITIAL_SLOTS;
+    pool_slot_t* new_slots = calloc(new_count, sizeof(pool_slot_t));
+    if (!new_slots) return false;
+
+    for (size_t i = 0; i < slot_count; i++)
+    {
+        if (!slots[i].used) continue;
+
+        size_t index = slots[i].hash & (new_count - 1);
+        while (new_slots[index].used)
+        {
+            index = (index + 1) & (new_count - 1);
+        }
+        new_slots[index] = slots[i];
+    }
+
+    free(slots);
+    slots = new_slots;
+    slot_count = new_count;
+    return true;
+}
+
+static string_ref_t store_string(const char* string, size_t length)
+{
+    size_t size = length + 1;
+    if (chunk_count == 0 || current_chunk_size - current_chunk_used < size)
+    {
+        size_t chunk_size = size > POOL_CHUNK_SIZE ? size : POOL_CHUNK_SIZE;
+        char* chunk = chunk_count < POOL_MAX_CHUNKS ? malloc(chunk_size) : NULL;
+        if (!chunk) return STRING_REF_INVALID;
+        chunks[chunk_count++] = chunk;
+        current_chunk_used = 0;
+        current_chunk_size = chunk_size;
+    }
+
+    string_ref_t ref = ((chunk_count - 1) << 16) | (string_ref_t)current_chunk_used;
+    char* copy = chunks[chunk_count - 1] + current_chunk_used;
+    memcpy(copy, string, length);
+    copy[length] = '\0';
+    current_chunk_used += size;
+    return ref;
+}
+
+string_ref_t string_pool_intern(const char* string, size_t length)
+{
+    if (!string) return STRING_REF_INVALID;
+
+    uint32_t hash = hash_string(string, length);
+
+    pthread_mutex_lock(&pool_mutex);
+    if ((stats.unique_strings + 1) * 2 > slot_count && !grow_slots())
+    {
+        pthread_mutex_unlock(&pool_mutex);
+        fprintf(stderr, "Failed to allocate memory for string pool\n");
+        return STRING_REF_INVALID;
+    }
+
+    size_t index = hash & (slot_count - 1);
+    while (slots[index].used)
+    {
+        if (slots[index].hash == hash && slots[index].length == length &&
+            memcmp(string_pool_get(slots[index].ref), string, length) == 0)
+        {
+            break;
+        }
+        index = (index + 1) & (slot_count - 1);
+    }
+
+    if (!slots[index].used)
+    {
+        string_ref_t ref = store_string(string, length);
+        if (ref == STRING_REF_INVALID)
+        {
+            pthread_mutex_unlock(&pool_mutex);
+            fprintf(stderr, "Failed to allocate memory for string pool\n");
+            return STRING_REF_INVALID;
+        }
+        slots[index].ref = ref;
+        slots[index].length = length;
+        slots[index].hash = hash;
+        slots[index].used = true;
+        stats.unique_strings++;
+        stats.bytes_stored += length + 1;
+    }
+
+    string_ref_t ref = slots[index].ref;
+    stats.references++;
+    stats.bytes_requested += length + 1;
+    pthread_mutex_unlock(&pool_mutex);
+
+    return ref;
+}
+
+const char* string_pool_get(string_ref_t ref)
+{
+    if (ref == STRING_REF_INVALID) return "";
+    return chunks[ref >> 16] + (ref & 0xFFFF);
+}
+
+void string_pool_get_stats(string_pool_stats_t* out_stats)
+{
+    if (!out_stats) return;
+
+    pthread_mutex_lock(&pool_mutex);
+    *out_stats = stats;
+    pthread_mutex_unlock(&pool_mutex);
+}
@@ -0,0 +1,50 @@
+﻿#ifndef STRING_POOL_H
+#define STRING_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * String pool counters.
+ */
+typedef struct {
+    uint32_t unique_strings;    /* Distinct strings stored */
+    uint64_t references;        /* Calls to string_pool_intern(), i.e. strings handed out */
+    size_t bytes_stored;        /* Bytes of the distinct strings, terminators included */
+    size_t bytes_requested;     /* Bytes all references would take as separate copies */
+} string_pool_stats_t;
+
+/**
+ * Compact reference to a pooled string: chunk index in the high 16 bits, offset in the low 16 bits.
+ */
+typedef uint32_t string_ref_t;
+
+// Reference returned when a string could not be pooled
+#define STRING_REF_INVALID UINT32_MAX
+
+/**
+ * Returns the reference of the pooled copy of a string, storing it on first use.
+ * Equal strings always get the same reference, which stays valid for the lifetime of the process,
+ * so lessons of every cached day and room share one copy of each teacher, group and subject name.
+ * @param string Pointer to the characters of the string, not necessarily terminated.
+ * @param length Number of characters.
+ * @return The reference of the pooled string, or STRING_REF_INVALID if memory could not be allocated.
+ * @note Safe to call from any thread.
+ */
+string_ref_t string_pool_intern(const char* string, size_t length);
+
+/**
+ * Resolves a reference returned by string_pool_intern().
+ * @param ref Reference of a pooled string.
+ * @return The pooled, terminated string, or "" for STRING_REF_INVALID.
+ * @note Safe to call from any thread that received the reference.
+ */
+const char* string_pool_get(string_ref_t ref);
+
+/**
+ * Reads the pool counters.
+ * @param stats Pointer to a string_pool_stats_t that receives the counters.
+ */
+void string_pool_get_stats(string_pool_stats_t* stats);
+
+#endif
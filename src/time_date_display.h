@@ -11,7 +11,7 @@ void init_time_and_date_display(void);
 /**
  * Updates the time and date display.
  * Refreshes the labels with the current time and date based on the system clock.
- * @note Should be called periodically (e.g., every minute) to keep the display up-to-date.
+ * @note Called by the UI scheduler at every minute rollover.
  */
 void update_time_and_date_display(void);
 
@@ -0,0 +1,69 @@
+﻿#include "ui_scheduler.h"
+#include "schedule_ui.h"
+#include "time_date_display.h"
+#include <lvgl/lvgl.h>
+#include <stdint.h>
+#include <time.h>
+
+static lv_timer_t* scheduler_timer;
+static time_t displayed_minute = -1; // Start of the minute last shown, -1 before the first tick
+
+// Milliseconds until the local clock reaches the next minute
+static uint32_t get_delay_to_next_minute(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    struct tm local_time;
+    localtime_r(&now.tv_sec, &local_time);
+
+    int seconds = local_time.tm_sec < 60 ? local_time.tm_sec : 59; // Leap second
+    return (uint32_t)(60 - seconds) * 1000 - (uint32_t)(now.tv_nsec / 1000000);
+}
+
+void ui_scheduler_reschedule(void)
+{
+    if (!scheduler_timer) return;
+
+    uint32_t delay_ms = get_delay_to_next_minute();
+
+    // An elapsed inactivity duration is handled on the minute ticks
+    uint32_t inactivity_delay_ms = get_inactivity_delay();
+    if (inactivity_delay_ms > 0 && inactivity_delay_ms < delay_ms)
+    {
+        delay_ms = inactivity_delay_ms;
+    }
+
+    lv_timer_reset(scheduler_timer);
+    lv_timer_set_period(scheduler_timer, delay_ms);
+}
+
+static void scheduler_cb(lv_timer_t* timer)
+{
+    (void)timer;
+
+    time_t now = time(NULL);
+    struct tm current_time;
+    localtime_r(&now, &current_time);
+
+    // An early wake-up only re-arms the timer, a late one still sees the new minute
+    time_t minute = now - current_time.tm_sec;
+    if (minute != displayed_minute)
+    {
+        displayed_minute = minute;
+        update_time_and_date_display();
+        update_progress_bar();
+    }
+
+    if (get_inactivity_delay() == 0)
+    {
+        show_today_schedule();
+    }
+
+    ui_scheduler_reschedule();
+}
+
+void ui_scheduler_init(void)
+{
+    scheduler_timer = lv_timer_create(scheduler_cb, get_delay_to_next_minute(), NULL);
+    scheduler_cb(scheduler_timer);
+}
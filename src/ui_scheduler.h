@@ -0,0 +1,19 @@
+﻿#ifndef UI_SCHEDULER_H
+#define UI_SCHEDULER_H
+
+/**
+ * Starts the scheduler of the time-driven UI updates.
+ * A single LVGL timer is armed for the next wall-clock event: the minute rollover, which also
+ * covers lesson starts and ends and the date change at midnight, or an earlier inactivity
+ * deadline. The minute is compared rather than polled, so a late wake-up never loses a tick.
+ * @note Must be called after the UI is initialized.
+ */
+void ui_scheduler_init(void);
+
+/**
+ * Re-arms the scheduler timer, e.g. after the displayed date changed and the inactivity deadline moved.
+ * @note Must be called from the LVGL thread.
+ */
+void ui_scheduler_reschedule(void);
+
+#endif